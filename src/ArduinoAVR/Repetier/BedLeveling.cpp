@@ -165,6 +165,7 @@ void Printer::prepareForProbing() {
 bool measureAutolevelPlane(Plane &plane) {
     PlaneBuilder builder;
     builder.reset();
+    millis_t probingStart = HAL::timeInMilliseconds();
 #if BED_LEVELING_METHOD == 0 // 3 point
     float h;
     Printer::moveTo(EEPROM::zProbeX1(), EEPROM::zProbeY1(), IGNORE_COORDINATE, IGNORE_COORDINATE, EEPROM::zProbeXYSpeed());
@@ -191,7 +192,8 @@ bool measureAutolevelPlane(Plane &plane) {
     float bx = delta * (EEPROM::zProbeX3() - EEPROM::zProbeX1());
     float by = delta * (EEPROM::zProbeY3() - EEPROM::zProbeY1());
     for(int ix = 0; ix < BED_LEVELING_GRID_SIZE; ix++) {
-        for(int iy = 0; iy < BED_LEVELING_GRID_SIZE; iy++) {
+        for(int iyStep = 0; iyStep < BED_LEVELING_GRID_SIZE; iyStep++) {
+            int iy = (ix & 1) ? BED_LEVELING_GRID_SIZE - 1 - iyStep : iyStep; // serpentine path, no travel back to row start
             float px = ox + static_cast<float>(ix) * ax + static_cast<float>(iy) * bx;
             float py = oy + static_cast<float>(ix) * ay + static_cast<float>(iy) * by;
             Printer::moveTo(px, py, IGNORE_COORDINATE, IGNORE_COORDINATE, EEPROM::zProbeXYSpeed());
@@ -239,6 +241,7 @@ bool measureAutolevelPlane(Plane &plane) {
 #else
 #error Unknown bed leveling method
 #endif
+    Com::printFLN(PSTR("Probing time [s]:"), (HAL::timeInMilliseconds() - probingStart) * 0.001f, 1);
     builder.createPlane(plane, false);
     return true;
 }
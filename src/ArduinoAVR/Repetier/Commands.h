@@ -24,6 +24,62 @@
 #ifndef COMMANDS_H_INCLUDED
 #define COMMANDS_H_INCLUDED
 
+/** Tasks run by the scheduler in the command loop. */
+enum SchedulerTask {
+    TASK_SERIAL = 0,
+    TASK_PLANNER,
+    TASK_TEMPERATURE,
+    TASK_MONITOR,
+    TASK_UI,
+    TASK_SD_PREFETCH,
+    TASK_EEPROM,
+    TASK_OUTPUT,
+    SCHEDULER_TASKS
+};
+
+/** Cooperative deadline scheduler for the periodical tasks. Each task has its next deadline in
+milliseconds. Deferrable tasks wait while the planner needs new moves, so command intake never
+waits behind a slow display refresh. */
+class Scheduler
+{
+public:
+    static bool isDue(uint8_t task, millis_t now, bool deferrable);
+    static inline void schedule(uint8_t task, millis_t now, millis_t period) {
+        nextRun[task] = now + period;
+    }
+    static bool plannerNeedsData();
+#ifdef DEBUG_SCHEDULER_TIMING
+    static void account(uint8_t task, uint32_t micros);
+    static void report();
+    static void reset();
+#endif
+private:
+    static millis_t nextRun[SCHEDULER_TASKS];
+#ifdef DEBUG_SCHEDULER_TIMING
+    static uint32_t runs[SCHEDULER_TASKS];
+    static uint32_t totalMicros[SCHEDULER_TASKS];
+    static uint32_t maxMicros[SCHEDULER_TASKS];
+    static uint32_t deferred[SCHEDULER_TASKS];
+#endif
+};
+
+/** Measures the run time of a task for the scheduler statistics while in scope. */
+class SchedulerTaskTimer
+{
+#ifdef DEBUG_SCHEDULER_TIMING
+    uint8_t task;
+    uint32_t start;
+public:
+    SchedulerTaskTimer(uint8_t _task): task(_task), start(HAL::timeInMicroseconds()) {}
+    ~SchedulerTaskTimer() {
+        Scheduler::account(task, HAL::timeInMicroseconds() - start);
+    }
+#else
+public:
+    SchedulerTaskTimer(uint8_t) {}
+#endif
+};
+
 class Commands
 {
 public:
@@ -46,6 +102,7 @@ public:
     static void checkFreeMemory();
     static void writeLowestFreeRAM();
 private:
+    static void executeNextCommand(GCode *code);
     static int lowestRAMValue;
     static int lowestRAMValueSend;
 };
@@ -1702,7 +1702,7 @@ motorized bed leveling */
 #define DISTORTION_XMAX 190
 #define DISTORTION_YMAX 190
 
-/** Uses EEPROM instead of ram. Allows bigger matrix (up to 22x22) without any ram cost.
+/** Uses EEPROM instead of ram. Allows bigger matrix (up to 22x22, 31x31 with DISTORTION_INT16) without any ram cost.
   Especially on arm based systems with cached EEPROM it is good, on AVR it has a small
   performance penalty.
 */
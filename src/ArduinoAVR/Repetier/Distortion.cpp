@@ -77,6 +77,19 @@ void Distortion::init() {
     updateDerived();
 #if !DISTORTION_PERMANENT
     resetCorrection();
+#else
+#if EEPROM_MODE != 0
+    uint8_t storedLayout = EEPROM::getZCorrectionLayout();
+    uint8_t layout = (storedLayout == 255 ? 0 : storedLayout); // 255 = never written, matrix from firmware without marker
+    if(layout != DISTORTION_LAYOUT && (layout == 0 || (layout & 0x80))) { // stored with other value size, would be garbage
+        Com::printWarningFLN(PSTR("Z correction storage changed, measure it again."));
+        resetCorrection();
+        EEPROM::setZCorrectionEnabled(0);
+    }
+    if(storedLayout != DISTORTION_LAYOUT)
+        EEPROM::setZCorrectionLayout(DISTORTION_LAYOUT);
+#endif
+    readMatrix();
 #endif
 #if EEPROM_MODE != 0
     enabled = EEPROM::isZCorrectionEnabled();
@@ -99,6 +112,15 @@ void Distortion::updateDerived() {
 #endif
     zStart = DISTORTION_START_DEGRADE * Printer::axisStepsPerMM[Z_AXIS] + Printer::zMinSteps;
     zEnd = DISTORTION_END_HEIGHT * Printer::axisStepsPerMM[Z_AXIS] + Printer::zMinSteps;
+    cellXStart = cellYStart = -2000000000L; // cell sizes changed, so forget last cell
+}
+
+/** \brief Refreshes the ram copy of a permanent matrix from EEPROM. */
+void Distortion::readMatrix() {
+#if DISTORTION_PERMANENT && DISTORTION_RAM_CACHE
+    for(int i = 0; i < DISTORTION_CORRECTION_POINTS * DISTORTION_CORRECTION_POINTS; i++)
+        matrix[i] = EEPROM::getZCorrection(i);
+#endif
 }
 
 void Distortion::enable(bool permanent) {
@@ -138,22 +160,41 @@ int Distortion::matrixIndex(fast8_t x, fast8_t y) const {
 }
 
 int32_t Distortion::getMatrix(int index) const {
-#if DISTORTION_PERMANENT
+#if DISTORTION_PERMANENT && !DISTORTION_RAM_CACHE
     return EEPROM::getZCorrection(index);
 #else
     return matrix[index];
 #endif
 }
 void Distortion::setMatrix(int32_t val, int index) {
+#if DISTORTION_INT16
+    if(val > 32767 || val < -32767) {
+        Com::printWarningFLN(PSTR("Distortion value exceeds 16 bit storage, limiting it."));
+        val = RMath::min(static_cast<int32_t>(32767), RMath::max(static_cast<int32_t>(-32767), val));
+    }
+#endif
 #if DISTORTION_PERMANENT
 #if EEPROM_MODE != 0
     EEPROM::setZCorrection(val, index);
 #endif
-#else
+#endif
+#if !DISTORTION_PERMANENT || DISTORTION_RAM_CACHE
     matrix[index] = val;
 #endif
 }
 
+/**
+ Floor of v / size for grid cells, also for negative v. The last cell is remembered, so
+ positions inside the same cell need no division.
+*/
+inline int32_t Distortion::cellFloor(int32_t v, int32_t size, int32_t &cellStart, int32_t &cellIndex) const {
+    if(v >= cellStart && v - cellStart < size)
+        return cellIndex;
+    cellIndex = (v - (v < 0 ? size - 1 : 0)) / size; // special case floor for negative integers!
+    cellStart = cellIndex * size;
+    return cellIndex;
+}
+
 bool Distortion::isCorner(fast8_t i, fast8_t j) const {
     return (i == 0 || i == DISTORTION_CORRECTION_POINTS - 1)
            && (j == 0 || j == DISTORTION_CORRECTION_POINTS - 1);
@@ -208,10 +249,13 @@ bool Distortion::measure(void) {
     zCorrection -= Printer::zBedOffset * Printer::axisStepsPerMM[Z_AXIS];
 #endif
 
+    millis_t probingStart = HAL::timeInMilliseconds();
     Printer::startProbing(true);
     Printer::moveToReal(IGNORE_COORDINATE, IGNORE_COORDINATE, z, IGNORE_COORDINATE, Printer::homingFeedrate[Z_AXIS]);
     for (iy = DISTORTION_CORRECTION_POINTS - 1; iy >= 0; iy--)
-        for (ix = 0; ix < DISTORTION_CORRECTION_POINTS; ix++) {
+        for (fast8_t ixStep = 0; ixStep < DISTORTION_CORRECTION_POINTS; ixStep++) {
+            // serpentine path, so we never travel back to the row start
+            ix = ((DISTORTION_CORRECTION_POINTS - 1 - iy) & 1) ? DISTORTION_CORRECTION_POINTS - 1 - ixStep : ixStep;
 #if (DRIVE_SYSTEM == DELTA) && DISTORTION_EXTRAPOLATE_CORNERS
             if (isCorner(ix, iy)) continue;
 #endif
@@ -241,6 +285,7 @@ bool Distortion::measure(void) {
                       matrixIndex(ix, iy));
         }
     Printer::finishProbing();
+    Com::printFLN(PSTR("Probing time [s]:"), (HAL::timeInMilliseconds() - probingStart) * 0.001f, 1);
 #if (DRIVE_SYSTEM == DELTA) && DISTORTION_EXTRAPOLATE_CORNERS
     extrapolateCorners();
 #endif
@@ -294,13 +339,13 @@ int32_t Distortion::correct(int32_t x, int32_t y, int32_t z) const {
 #if DRIVE_SYSTEM == DELTA
     x += radiusCorrectionSteps;
     y += radiusCorrectionSteps;
-    int32_t fxFloor = (x - (x < 0 ? step - 1 : 0)) / step; // special case floor for negative integers!
-    int32_t fyFloor = (y - (y < 0 ? step - 1 : 0)) / step;
+    int32_t fxFloor = cellFloor(x, step, cellXStart, cellXIndex);
+    int32_t fyFloor = cellFloor(y, step, cellYStart, cellYIndex);
 #else
     x -= xOffsetSteps;
     y -= yOffsetSteps;
-    int32_t fxFloor = (x - (x < 0 ? xCorrectionSteps - 1 : 0)) / xCorrectionSteps; // special case floor for negative integers!
-    int32_t fyFloor = (y - (y < 0 ? yCorrectionSteps - 1 : 0)) / yCorrectionSteps;
+    int32_t fxFloor = cellFloor(x, xCorrectionSteps, cellXStart, cellXIndex);
+    int32_t fyFloor = cellFloor(y, yCorrectionSteps, cellYStart, cellYIndex);
 #endif
 // indexes to the matrix
 
@@ -20,6 +20,15 @@
 #define _DISTORTION_H
 
 #if DISTORTION_CORRECTION || defined(DOXYGEN)
+#if DISTORTION_INT16
+typedef int16_t distortion_t;
+#else
+typedef int32_t distortion_t;
+#endif
+/** Marks the layout of the permanent matrix in EEPROM. 0 and an unwritten 255 are the original
+32 bit layout, so existing matrices stay valid. */
+#define DISTORTION_LAYOUT (DISTORTION_INT16 ? 0x80 | DISTORTION_CORRECTION_POINTS : 0)
+
 /** \brief Handle distortion related stuff.
 
 Distortion correction can be used to solve problems resulting from an uneven build plate.
@@ -58,8 +67,10 @@ public:
     void set(float x, float y, float z);
     void showMatrix();
     void resetCorrection();
+    void readMatrix();
 private:
     int matrixIndex(fast8_t x, fast8_t y) const;
+    INLINE int32_t cellFloor(int32_t v, int32_t size, int32_t &cellStart, int32_t &cellIndex) const;
     int32_t getMatrix(int index) const;
     void setMatrix(int32_t val, int index);
     bool isCorner(fast8_t i, fast8_t j) const;
@@ -76,8 +87,11 @@ private:
     int32_t yCorrectionSteps, yOffsetSteps;
 #endif
     int32_t zStart, zEnd;
-#if !DISTORTION_PERMANENT
-    int32_t matrix[DISTORTION_CORRECTION_POINTS * DISTORTION_CORRECTION_POINTS];
+    // Last grid cell found by correct, consecutive positions are mostly inside the same cell
+    mutable int32_t cellXStart, cellXIndex;
+    mutable int32_t cellYStart, cellYIndex;
+#if !DISTORTION_PERMANENT || DISTORTION_RAM_CACHE
+    distortion_t matrix[DISTORTION_CORRECTION_POINTS * DISTORTION_CORRECTION_POINTS];
 #endif
     bool enabled;
 };
@@ -51,6 +51,10 @@ void EEPROM::update(GCode *com)
         HAL::eprSetByte(EPR_INTEGRITY_BYTE, newcheck);
     bool includesEeprom = com->P >= EEPROM_EXTRUDER_OFFSET && com->P < EEPROM_EXTRUDER_OFFSET + 6 * EEPROM_EXTRUDER_LENGTH;
     readDataFromEEPROM(includesEeprom);
+#if DISTORTION_CORRECTION
+    if(com->P >= 2048) // distortion matrix
+        Printer::distortion.readMatrix();
+#endif
 #if MIXING_EXTRUDER
     Extruder::selectExtruderById(Extruder::activeMixingExtruder);
 #else
@@ -131,6 +135,7 @@ void EEPROM::restoreEEPROMSettingsFromConfiguration()
     e->maxAcceleration = EXT0_MAX_ACCELERATION;
     e->tempControl.heatManager = EXT0_HEAT_MANAGER;
     e->tempControl.preheatTemperature = EXT0_PREHEAT_TEMP;
+    e->tempControl.feedForward = EXTRUDER_FEED_FORWARD;
     e->tempControl.pidDriveMax = EXT0_PID_INTEGRAL_DRIVE_MAX;
     e->tempControl.pidDriveMin = EXT0_PID_INTEGRAL_DRIVE_MIN;
     e->tempControl.pidPGain = EXT0_PID_PGAIN_OR_DEAD_TIME;
@@ -160,6 +165,7 @@ void EEPROM::restoreEEPROMSettingsFromConfiguration()
     e->maxAcceleration = EXT1_MAX_ACCELERATION;
     e->tempControl.heatManager = EXT1_HEAT_MANAGER;
     e->tempControl.preheatTemperature = EXT1_PREHEAT_TEMP;
+    e->tempControl.feedForward = EXTRUDER_FEED_FORWARD;
     e->tempControl.pidDriveMax = EXT1_PID_INTEGRAL_DRIVE_MAX;
     e->tempControl.pidDriveMin = EXT1_PID_INTEGRAL_DRIVE_MIN;
     e->tempControl.pidPGain = EXT1_PID_PGAIN_OR_DEAD_TIME;
@@ -189,6 +195,7 @@ void EEPROM::restoreEEPROMSettingsFromConfiguration()
     e->maxAcceleration = EXT2_MAX_ACCELERATION;
     e->tempControl.heatManager = EXT2_HEAT_MANAGER;
     e->tempControl.preheatTemperature = EXT2_PREHEAT_TEMP;
+    e->tempControl.feedForward = EXTRUDER_FEED_FORWARD;
     e->tempControl.pidDriveMax = EXT2_PID_INTEGRAL_DRIVE_MAX;
     e->tempControl.pidDriveMin = EXT2_PID_INTEGRAL_DRIVE_MIN;
     e->tempControl.pidPGain = EXT2_PID_PGAIN_OR_DEAD_TIME;
@@ -218,6 +225,7 @@ void EEPROM::restoreEEPROMSettingsFromConfiguration()
     e->maxAcceleration = EXT3_MAX_ACCELERATION;
     e->tempControl.heatManager = EXT3_HEAT_MANAGER;
     e->tempControl.preheatTemperature = EXT3_PREHEAT_TEMP;
+    e->tempControl.feedForward = EXTRUDER_FEED_FORWARD;
     e->tempControl.pidDriveMax = EXT3_PID_INTEGRAL_DRIVE_MAX;
     e->tempControl.pidDriveMin = EXT3_PID_INTEGRAL_DRIVE_MIN;
     e->tempControl.pidPGain = EXT3_PID_PGAIN_OR_DEAD_TIME;
@@ -247,6 +255,7 @@ void EEPROM::restoreEEPROMSettingsFromConfiguration()
     e->maxAcceleration = EXT4_MAX_ACCELERATION;
     e->tempControl.heatManager = EXT4_HEAT_MANAGER;
     e->tempControl.preheatTemperature = EXT4_PREHEAT_TEMP;
+    e->tempControl.feedForward = EXTRUDER_FEED_FORWARD;
     e->tempControl.pidDriveMax = EXT4_PID_INTEGRAL_DRIVE_MAX;
     e->tempControl.pidDriveMin = EXT4_PID_INTEGRAL_DRIVE_MIN;
     e->tempControl.pidPGain = EXT4_PID_PGAIN_OR_DEAD_TIME;
@@ -276,6 +285,7 @@ void EEPROM::restoreEEPROMSettingsFromConfiguration()
     e->maxAcceleration = EXT5_MAX_ACCELERATION;
     e->tempControl.heatManager = EXT5_HEAT_MANAGER;
     e->tempControl.preheatTemperature = EXT5_PREHEAT_TEMP;
+    e->tempControl.feedForward = EXTRUDER_FEED_FORWARD;
     e->tempControl.pidDriveMax = EXT5_PID_INTEGRAL_DRIVE_MAX;
     e->tempControl.pidDriveMin = EXT5_PID_INTEGRAL_DRIVE_MIN;
     e->tempControl.pidPGain = EXT5_PID_PGAIN_OR_DEAD_TIME;
@@ -415,6 +425,7 @@ void EEPROM::storeDataIntoEEPROM(uint8_t corrupted)
         HAL::eprSetFloat(o+EPR_EXTRUDER_MAX_ACCELERATION,e->maxAcceleration);
         HAL::eprSetByte(o+EPR_EXTRUDER_HEAT_MANAGER,e->tempControl.heatManager);
         HAL::eprSetInt16(o+EPR_EXTRUDER_PREHEAT,e->tempControl.preheatTemperature);
+        HAL::eprSetFloat(o+EPR_EXTRUDER_FEED_FORWARD,e->tempControl.feedForward);
         HAL::eprSetByte(o+EPR_EXTRUDER_DRIVE_MAX,e->tempControl.pidDriveMax);
         HAL::eprSetByte(o+EPR_EXTRUDER_DRIVE_MIN,e->tempControl.pidDriveMin);
         HAL::eprSetFloat(o+EPR_EXTRUDER_PID_PGAIN,e->tempControl.pidPGain);
@@ -519,7 +530,7 @@ void EEPROM::initalizeUncached()
     HAL::eprSetFloat(EPR_PARK_X,PARK_POSITION_X);
     HAL::eprSetFloat(EPR_PARK_Y,PARK_POSITION_Y);
     HAL::eprSetFloat(EPR_PARK_Z,PARK_POSITION_Z_RAISE);
-
+    HAL::eprSetInt16(EPR_PRINTLINE_CACHE_SIZE,PRINTLINE_CACHE_SIZE);
 }
 
 void EEPROM::readDataFromEEPROM(bool includeExtruder)
@@ -650,6 +661,10 @@ void EEPROM::readDataFromEEPROM(bool includeExtruder)
                 HAL::eprSetInt32(o+EPR_EXTRUDER_Z_OFFSET,e->zOffset);
             }
             e->zOffset = HAL::eprGetInt32(o + EPR_EXTRUDER_Z_OFFSET);
+            if(version < 21) {
+                HAL::eprSetFloat(o+EPR_EXTRUDER_FEED_FORWARD,EXTRUDER_FEED_FORWARD);
+            }
+            e->tempControl.feedForward = HAL::eprGetFloat(o+EPR_EXTRUDER_FEED_FORWARD);
         }
     }
     if(version != EEPROM_PROTOCOL_VERSION)
@@ -783,6 +798,12 @@ void EEPROM::readDataFromEEPROM(bool includeExtruder)
 		    HAL::eprSetFloat(EPR_PARK_Y,PARK_POSITION_Y);
 		    HAL::eprSetFloat(EPR_PARK_Z,PARK_POSITION_Z_RAISE);
 		}
+        if(version < 20) {
+            HAL::eprSetInt16(EPR_PRINTLINE_CACHE_SIZE,PRINTLINE_CACHE_SIZE);
+        }
+        if(version < 21) {
+            HAL::eprSetByte(EPR_DISTORTION_LAYOUT,0); // matrix so far was always stored 32 bit
+        }
         /*        if (version<8) {
         #if DRIVE_SYSTEM==DELTA
                   // Prior to version 8, the Cartesian max was stored in the zmax
@@ -802,6 +823,9 @@ void EEPROM::readDataFromEEPROM(bool includeExtruder)
         storeDataIntoEEPROM(false); // Store new fields for changed version
     }
     Printer::zBedOffset = HAL::eprGetFloat(EPR_Z_PROBE_Z_OFFSET);
+#if CPU_ARCH == ARCH_ARM
+    PrintLine::setQueueLength(HAL::eprGetInt16(EPR_PRINTLINE_CACHE_SIZE));
+#endif
 #if UI_DISPLAY_TYPE != NO_DISPLAY
     Com::selectLanguage(HAL::eprGetByte(EPR_SELECTED_LANGUAGE));
 #endif
@@ -927,6 +951,9 @@ writeFloat(EPR_X2AXIS_STEPS_PER_MM, Com::tEPRX2StepsPerMM, 4);
 	writeFloat(EPR_PARK_X, PSTR("Park position X [mm]"));
 	writeFloat(EPR_PARK_Y, PSTR("Park position Y [mm]"));
 	writeFloat(EPR_PARK_Z, PSTR("Park position Z raise [mm]"));
+#if CPU_ARCH == ARCH_ARM
+    writeInt(EPR_PRINTLINE_CACHE_SIZE, PSTR("Move queue length [lines]"));
+#endif
 
 #if ENABLE_BACKLASH_COMPENSATION
     writeFloat(EPR_BACKLASH_X, Com::tEPRXBacklash);
@@ -1045,6 +1072,7 @@ writeFloat(EPR_X2AXIS_STEPS_PER_MM, Com::tEPRX2StepsPerMM, 4);
         writeFloat(o + EPR_EXTRUDER_PID_PGAIN, Com::tEPRPGain,4);
         writeFloat(o + EPR_EXTRUDER_PID_IGAIN, Com::tEPRIGain,4);
         writeFloat(o + EPR_EXTRUDER_PID_DGAIN, Com::tEPRDGain,4);
+        writeFloat(o + EPR_EXTRUDER_FEED_FORWARD, Com::tEPRFeedForward,3);
         writeByte(o + EPR_EXTRUDER_PID_MAX, Com::tEPRPIDMaxValue);
         writeLong(o + EPR_EXTRUDER_X_OFFSET, Com::tEPRXOffset);
         writeLong(o + EPR_EXTRUDER_Y_OFFSET, Com::tEPRYOffset);
@@ -1192,7 +1220,11 @@ void EEPROM::restoreMixingRatios()
 
 void EEPROM::setZCorrection(int32_t c,int index)
 {
+#if DISTORTION_INT16
+    HAL::eprSetInt16(2048 + (index << 1), c);
+#else
     HAL::eprSetInt32(2048 + (index << 2), c);
+#endif
 }
 
 #endif
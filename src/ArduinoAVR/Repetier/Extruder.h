@@ -61,6 +61,7 @@ public:
     millis_t decoupleTestPeriod; ///< Time between setting and testing decoupling.
     millis_t preheatStartTime;    ///< Time (in milliseconds) when heat up was started
     int16_t preheatTemperature;
+    float feedForward; ///< PWM added per mm/s queued filament speed, 0 = off
 
     void setTargetTemperature(float target);
     void updateCurrentTemperature();
@@ -156,6 +157,7 @@ public:
 #endif
     void waitForTargetTemperature();
     void autotunePID(float temp,uint8_t controllerId,int maxCycles,bool storeResult, int method);
+    void autotuneFeedForward(float temp, uint8_t controllerId, float speed, bool storeResult);
    inline void startPreheatTime()
    {
        preheatStartTime = HAL::timeInMilliseconds();
@@ -239,6 +241,10 @@ public:
     static uint8_t mixingDir; ///< Direction flag
     static uint8_t activeMixingExtruder;
 	static void recomputeMixingExtruderSteps();
+#if MIXING_PATTERN_LENGTH
+    static uint8_t mixingPattern[MIXING_PATTERN_LENGTH]; ///< Drive for each e step, 255 = none
+    static uint8_t mixingPatternPos; ///< Next pattern entry for a positive step
+#endif
 #endif
     uint8_t id;
     int32_t xOffset;
@@ -222,10 +222,17 @@ int32_t HAL::CPUDivU2(unsigned int divisor) {
 #endif
 }
 
+#if PWM_PORT_SCHEDULE
+static void pwmSetupChannels();
+#endif
+
 void HAL::setupTimer() {
 #if USE_ADVANCE
     EXTRUDER_TCCR = 0; // need Normal not fastPWM set by arduino init
     EXTRUDER_TIMSK |= (1 << EXTRUDER_OCIE); // Activate compa interrupt on timer 0
+#endif
+#if PWM_PORT_SCHEDULE
+    pwmSetupChannels();
 #endif
     PWM_TCCR = 0;  // Setup PWM interrupt
     PWM_OCR = 64;
@@ -675,7 +682,13 @@ ISR(TIMER1_COMPA_vect) {
     // insideTimer1 = 1;
     OCR1A = 61000;
     if(PrintLine::hasLines()) {
+#ifdef DEBUG_STEPPER_TIMING
+        uint32_t delay = PrintLine::bresenhamStep();
+        Printer::updateStepperTiming(TCNT1); // timer 1 runs without prescaler, so these are cpu cycles
+        setTimer(delay);
+#else
         setTimer(PrintLine::bresenhamStep());
+#endif
     }
 #if FEATURE_BABYSTEPPING
     else if(Printer::zBabystepsMissing) {
@@ -763,12 +776,205 @@ ISR(TIMER1_COMPA_vect) {
 #endif
 
 #define pulseDensityModulate( pin, density,error,invert) {uint8_t carry;carry = error + (invert ? 255 - density : density); WRITE(pin, (carry < error)); error = carry;}
+
+#if PWM_PORT_SCHEDULE
+/** Software PWM output. Heaters and coolers are switched by port masks, so pins on the same
+port change with one register write. */
+struct PwmChannel {
+    volatile uint8_t *port;
+    uint8_t mask;
+    uint8_t flags;
+    uint8_t *value;
+    uint8_t portIndex;
+    uint8_t error; ///< Accumulator for pulse density modulation
+};
+#define PWM_CHANNEL_COOLER 1
+#define PWM_CHANNEL_INVERTED 2
+#define PWM_CHANNEL_KICK_FAN1 4
+#define PWM_CHANNEL_KICK_FAN2 8
+#define PWM_HEATER (HEATER_PINS_INVERTED ? PWM_CHANNEL_INVERTED : 0)
+#define PWM_CHANNEL_(pin, value, flags) {&DIO ## pin ## _WPORT, MASK(DIO ## pin ## _PIN), flags, value, 0, 0}
+#define PWM_CHANNEL(pin, value, flags) PWM_CHANNEL_(pin, value, flags)
+
+static PwmChannel pwmChannels[] = {
+#if defined(EXT0_HEATER_PIN) && EXT0_HEATER_PIN > -1
+    PWM_CHANNEL(EXT0_HEATER_PIN, &pwm_pos[0], PWM_HEATER),
+#if EXT0_EXTRUDER_COOLER_PIN > -1
+    PWM_CHANNEL(EXT0_EXTRUDER_COOLER_PIN, &extruder[0].coolerPWM, PWM_CHANNEL_COOLER),
+#endif
+#endif
+#if defined(EXT1_HEATER_PIN) && EXT1_HEATER_PIN > -1 && NUM_EXTRUDER > 1 && !MIXING_EXTRUDER
+    PWM_CHANNEL(EXT1_HEATER_PIN, &pwm_pos[1], PWM_HEATER),
+#if !SHARED_COOLER && defined(EXT1_EXTRUDER_COOLER_PIN) && EXT1_EXTRUDER_COOLER_PIN > -1 && EXT1_EXTRUDER_COOLER_PIN != EXT0_EXTRUDER_COOLER_PIN
+    PWM_CHANNEL(EXT1_EXTRUDER_COOLER_PIN, &extruder[1].coolerPWM, PWM_CHANNEL_COOLER),
+#endif
+#endif
+#if defined(EXT2_HEATER_PIN) && EXT2_HEATER_PIN > -1 && NUM_EXTRUDER > 2 && !MIXING_EXTRUDER
+    PWM_CHANNEL(EXT2_HEATER_PIN, &pwm_pos[2], PWM_HEATER),
+#if !SHARED_COOLER && EXT2_EXTRUDER_COOLER_PIN > -1
+    PWM_CHANNEL(EXT2_EXTRUDER_COOLER_PIN, &extruder[2].coolerPWM, PWM_CHANNEL_COOLER),
+#endif
+#endif
+#if defined(EXT3_HEATER_PIN) && EXT3_HEATER_PIN > -1 && NUM_EXTRUDER > 3 && !MIXING_EXTRUDER
+    PWM_CHANNEL(EXT3_HEATER_PIN, &pwm_pos[3], PWM_HEATER),
+#if !SHARED_COOLER && EXT3_EXTRUDER_COOLER_PIN > -1
+    PWM_CHANNEL(EXT3_EXTRUDER_COOLER_PIN, &extruder[3].coolerPWM, PWM_CHANNEL_COOLER),
+#endif
+#endif
+#if defined(EXT4_HEATER_PIN) && EXT4_HEATER_PIN > -1 && NUM_EXTRUDER > 4 && !MIXING_EXTRUDER
+    PWM_CHANNEL(EXT4_HEATER_PIN, &pwm_pos[4], PWM_HEATER),
+#if !SHARED_COOLER && EXT4_EXTRUDER_COOLER_PIN > -1
+    PWM_CHANNEL(EXT4_EXTRUDER_COOLER_PIN, &extruder[4].coolerPWM, PWM_CHANNEL_COOLER),
+#endif
+#endif
+#if defined(EXT5_HEATER_PIN) && EXT5_HEATER_PIN > -1 && NUM_EXTRUDER > 5 && !MIXING_EXTRUDER
+    PWM_CHANNEL(EXT5_HEATER_PIN, &pwm_pos[5], PWM_HEATER),
+#if !SHARED_COOLER && EXT5_EXTRUDER_COOLER_PIN > -1
+    PWM_CHANNEL(EXT5_EXTRUDER_COOLER_PIN, &extruder[5].coolerPWM, PWM_CHANNEL_COOLER),
+#endif
+#endif
+#if FAN_BOARD_PIN > -1 && SHARED_COOLER_BOARD_EXT == 0
+    PWM_CHANNEL(FAN_BOARD_PIN, &pwm_pos[PWM_BOARD_FAN], PWM_CHANNEL_COOLER),
+#endif
+#if FAN_PIN > -1 && FEATURE_FAN_CONTROL
+    PWM_CHANNEL(FAN_PIN, &pwm_pos[PWM_FAN1], PWM_CHANNEL_COOLER | PWM_CHANNEL_KICK_FAN1),
+#endif
+#if FAN2_PIN > -1 && FEATURE_FAN2_CONTROL
+    PWM_CHANNEL(FAN2_PIN, &pwm_pos[PWM_FAN2], PWM_CHANNEL_COOLER | PWM_CHANNEL_KICK_FAN2),
+#endif
+#if defined(FAN_THERMO_PIN) && FAN_THERMO_PIN > -1
+    PWM_CHANNEL(FAN_THERMO_PIN, &pwm_pos[PWM_FAN_THERMO], PWM_CHANNEL_COOLER),
+#endif
+#if HEATED_BED_HEATER_PIN > -1 && HAVE_HEATED_BED
+    PWM_CHANNEL(HEATED_BED_HEATER_PIN, &pwm_pos[NUM_EXTRUDER], PWM_HEATER),
+#endif
+};
+#define PWM_CHANNELS (sizeof(pwmChannels) / sizeof(PwmChannel))
+
+/** Port change at one counter value of a pwm period. */
+struct PwmEvent {
+    uint8_t count;
+    uint8_t portIndex;
+    uint8_t set;
+    uint8_t clear;
+};
+/** Port changes of the running pwm period, sorted by counter value. */
+struct PwmSchedule {
+    PwmEvent events[PWM_CHANNELS];
+    uint8_t numEvents;
+    uint8_t nextEvent;
+};
+static volatile uint8_t *pwmPorts[PWM_CHANNELS];
+static uint8_t pwmNumPorts = 0;
+static PwmSchedule pwmHeaterSchedule, pwmCoolerSchedule;
+
+/** Assigns every channel the index of its port, called once before the pwm timer starts. */
+static void pwmSetupChannels() {
+    for(uint8_t i = 0; i < PWM_CHANNELS; i++) {
+        PwmChannel &c = pwmChannels[i];
+        uint8_t p = 0;
+        while(p < pwmNumPorts && pwmPorts[p] != c.port) p++;
+        if(p == pwmNumPorts)
+            pwmPorts[pwmNumPorts++] = c.port;
+        c.portIndex = p;
+    }
+}
+
+static INLINE uint8_t pwmChannelValue(PwmChannel &c) {
+#if FAN_PIN > -1 && FEATURE_FAN_CONTROL
+    if((c.flags & PWM_CHANNEL_KICK_FAN1) && fanKickstart) return MAX_FAN_PWM;
+#endif
+#if FAN2_PIN > -1 && FEATURE_FAN2_CONTROL
+    if((c.flags & PWM_CHANNEL_KICK_FAN2) && fan2Kickstart) return MAX_FAN_PWM;
+#endif
+    return *c.value;
+}
+
+/** Writes the collected set and clear masks of all ports. */
+static INLINE void pwmWritePorts(uint8_t *set, uint8_t *clear) {
+    for(uint8_t p = 0; p < pwmNumPorts; p++)
+        if(set[p] | clear[p])
+            *pwmPorts[p] = (*pwmPorts[p] | set[p]) & ~clear[p];
+}
+
+/** Starts a pwm period of all heaters or all coolers. Channels with output switch on
+together, and the switch off times get sorted into the schedule, so the interrupt only
+compares the counter with the next event. */
+static void pwmStartPeriod(PwmSchedule &s, uint8_t group, uint8_t pwmMask) {
+    uint8_t set[PWM_CHANNELS], clear[PWM_CHANNELS];
+    memset(set, 0, pwmNumPorts);
+    memset(clear, 0, pwmNumPorts);
+    s.numEvents = s.nextEvent = 0;
+    for(uint8_t i = 0; i < PWM_CHANNELS; i++) {
+        PwmChannel &c = pwmChannels[i];
+        if((c.flags & PWM_CHANNEL_COOLER) != group) continue;
+        uint8_t v = pwmChannelValue(c) & pwmMask;
+        bool inverted = c.flags & PWM_CHANNEL_INVERTED;
+        if((v > 0) != inverted) set[c.portIndex] |= c.mask;
+        else clear[c.portIndex] |= c.mask;
+        if(v == 0 || v == pwmMask) continue;
+        // insert switch off event sorted by time, merging events of the same port
+        uint8_t n = 0;
+        while(n < s.numEvents && (s.events[n].count < v || (s.events[n].count == v && s.events[n].portIndex != c.portIndex))) n++;
+        if(n == s.numEvents || s.events[n].count != v) {
+            memmove(&s.events[n + 1], &s.events[n], (s.numEvents - n) * sizeof(PwmEvent));
+            s.numEvents++;
+            s.events[n].count = v;
+            s.events[n].portIndex = c.portIndex;
+            s.events[n].set = s.events[n].clear = 0;
+        }
+        if(inverted) s.events[n].set |= c.mask;
+        else s.events[n].clear |= c.mask;
+    }
+    pwmWritePorts(set, clear);
+}
+
+/** Executes all switch events of the schedule due at counter value count. */
+static INLINE void pwmRunSchedule(PwmSchedule &s, uint8_t count) {
+    while(s.nextEvent < s.numEvents && s.events[s.nextEvent].count == count) {
+        PwmEvent &e = s.events[s.nextEvent++];
+        *pwmPorts[e.portIndex] = (*pwmPorts[e.portIndex] | e.set) & ~e.clear;
+    }
+}
+
+/** Pulse density modulation of all heaters or all coolers with one write per port. */
+static void pwmPulseDensity(uint8_t group) {
+    uint8_t set[PWM_CHANNELS], clear[PWM_CHANNELS];
+    memset(set, 0, pwmNumPorts);
+    memset(clear, 0, pwmNumPorts);
+    for(uint8_t i = 0; i < PWM_CHANNELS; i++) {
+        PwmChannel &c = pwmChannels[i];
+        if((c.flags & PWM_CHANNEL_COOLER) != group) continue;
+        uint8_t v = pwmChannelValue(c);
+        uint8_t carry = c.error + (c.flags & PWM_CHANNEL_INVERTED ? 255 - v : v);
+        if(carry < c.error) set[c.portIndex] |= c.mask;
+        else clear[c.portIndex] |= c.mask;
+        c.error = carry;
+    }
+    pwmWritePorts(set, clear);
+}
+#endif
 /**
 This timer is called 3906 timer per second. It is used to update pwm values for heater and some other frequent jobs.
 */
 ISR(PWM_TIMER_VECTOR) {
     static uint8_t pwm_count_cooler = 0;
     static uint8_t pwm_count_heater = 0;
+#if PWM_PORT_SCHEDULE
+    PWM_OCR += 64;
+#if PDM_FOR_EXTRUDER
+    pwmPulseDensity(0);
+#else
+    if(pwm_count_heater == 0) pwmStartPeriod(pwmHeaterSchedule, 0, HEATER_PWM_MASK);
+    else pwmRunSchedule(pwmHeaterSchedule, pwm_count_heater);
+#endif
+#if PDM_FOR_COOLER
+    pwmPulseDensity(PWM_CHANNEL_COOLER);
+#else
+    if(pwm_count_cooler == 0) pwmStartPeriod(pwmCoolerSchedule, PWM_CHANNEL_COOLER, COOLER_PWM_MASK);
+    else pwmRunSchedule(pwmCoolerSchedule, pwm_count_cooler);
+#endif
+#else // PWM_PORT_SCHEDULE
     static uint8_t pwm_pos_set[NUM_PWM];
 #if NUM_EXTRUDER > 0 && ((defined(EXT0_HEATER_PIN) && EXT0_HEATER_PIN > -1 && EXT0_EXTRUDER_COOLER_PIN > -1) || (NUM_EXTRUDER > 1 && EXT1_EXTRUDER_COOLER_PIN > -1 && EXT1_EXTRUDER_COOLER_PIN != EXT0_EXTRUDER_COOLER_PIN) || (NUM_EXTRUDER > 2 && EXT2_EXTRUDER_COOLER_PIN > -1 && EXT2_EXTRUDER_COOLER_PIN != EXT2_EXTRUDER_COOLER_PIN) || (NUM_EXTRUDER > 3 && EXT3_EXTRUDER_COOLER_PIN > -1 && EXT3_EXTRUDER_COOLER_PIN != EXT3_EXTRUDER_COOLER_PIN) || (NUM_EXTRUDER > 4 && EXT4_EXTRUDER_COOLER_PIN > -1 && EXT4_EXTRUDER_COOLER_PIN != EXT4_EXTRUDER_COOLER_PIN) || (NUM_EXTRUDER > 5 && EXT5_EXTRUDER_COOLER_PIN > -1 && EXT5_EXTRUDER_COOLER_PIN != EXT5_EXTRUDER_COOLER_PIN))
     static uint8_t pwm_cooler_pos_set[NUM_EXTRUDER];
@@ -974,6 +1180,7 @@ ISR(PWM_TIMER_VECTOR) {
     if(pwm_pos_set[NUM_EXTRUDER] == pwm_count_heater && pwm_pos_set[NUM_EXTRUDER] != HEATER_PWM_MASK) WRITE(HEATED_BED_HEATER_PIN, HEATER_PINS_INVERTED);
 #endif
 #endif
+#endif // PWM_PORT_SCHEDULE
     counterPeriodical++; // Approximate a 100ms timer
     if(counterPeriodical >= (int)(F_CPU / 40960)) {
         counterPeriodical = 0;
@@ -188,17 +188,27 @@ typedef uint8_t ufast8_t;
   Modified to use only 1 queue with fixed length by Repetier
 */
 
-#define SERIAL_BUFFER_SIZE 128
-#define SERIAL_BUFFER_MASK 127
-#undef SERIAL_TX_BUFFER_SIZE
-#undef SERIAL_TX_BUFFER_MASK
+// Buffer lengths can be set per board in Configuration.h. Power of 2, at most 256.
+#ifndef SERIAL_RX_BUFFER_LENGTH
+#define SERIAL_RX_BUFFER_LENGTH 128
+#endif
+#ifndef SERIAL_TX_BUFFER_LENGTH
 #ifdef BIG_OUTPUT_BUFFER
-  #define SERIAL_TX_BUFFER_SIZE 128
-  #define SERIAL_TX_BUFFER_MASK 127
+#define SERIAL_TX_BUFFER_LENGTH 128
 #else
-  #define SERIAL_TX_BUFFER_SIZE 64
-  #define SERIAL_TX_BUFFER_MASK 63
+#define SERIAL_TX_BUFFER_LENGTH 64
+#endif
 #endif
+#if (SERIAL_RX_BUFFER_LENGTH & (SERIAL_RX_BUFFER_LENGTH - 1)) || (SERIAL_TX_BUFFER_LENGTH & (SERIAL_TX_BUFFER_LENGTH - 1)) || SERIAL_RX_BUFFER_LENGTH > 256 || SERIAL_TX_BUFFER_LENGTH > 256
+#error SERIAL_RX_BUFFER_LENGTH and SERIAL_TX_BUFFER_LENGTH must be a power of 2 up to 256
+#endif
+#undef SERIAL_BUFFER_SIZE
+#undef SERIAL_TX_BUFFER_SIZE
+#undef SERIAL_TX_BUFFER_MASK
+#define SERIAL_BUFFER_SIZE SERIAL_RX_BUFFER_LENGTH
+#define SERIAL_BUFFER_MASK (SERIAL_RX_BUFFER_LENGTH - 1)
+#define SERIAL_TX_BUFFER_SIZE SERIAL_TX_BUFFER_LENGTH
+#define SERIAL_TX_BUFFER_MASK (SERIAL_TX_BUFFER_LENGTH - 1)
 
 struct ring_buffer
 {
@@ -582,6 +592,10 @@ public:
     {
         return millis();
     }
+    static inline uint32_t timeInMicroseconds()
+    {
+        return micros();
+    }
     static inline char readFlashByte(PGM_P ptr)
     {
         return pgm_read_byte(ptr);
@@ -610,6 +624,15 @@ public:
     {
         RFSERIAL.flush();
     }
+    // Bytes that can be written without waiting
+    static inline int serialOutputSpace()
+    {
+#ifndef EXTERNALSERIAL
+        return RFSERIAL.outputUnused() - 1;
+#else
+        return RFSERIAL.availableForWrite();
+#endif
+    }
     static void setupTimer();
     static void showStartReason();
     static int getFreeRam();
@@ -782,4 +805,10 @@ private:
 #define PWM_TIMSK TIMSK0
 #define PWM_OCIE OCIE0B
 //#endif
+/** Switch heater and cooler pins from a schedule of port masks build at the start of each
+pwm period. The interrupt then only compares the counter with the next switch time and pins
+on the same port change with one register write, instead of testing every channel. */
+#ifndef PWM_PORT_SCHEDULE
+#define PWM_PORT_SCHEDULE 0
+#endif
 #endif // HAL_H
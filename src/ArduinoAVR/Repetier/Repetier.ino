@@ -88,12 +88,13 @@ Custom M Codes
 - M23  - Select SD file (M23 filename.g)
 - M24  - Start/resume SD print
 - M25  - Pause SD print
-- M26  - Set SD position in bytes (M26 S12345)
+- M26  - Set SD position in bytes (M26 S12345) or layer of converted binary files (M26 L12)
 - M27  - Report SD print status
 - M28  - Start SD write (M28 filename.g)
 - M29  - Stop SD write
 - M30 <filename> - Delete file on sd card
 - M32 <dirname> create subdirectory
+- M35 <filename> - Convert file into binary file <name>.bgc with layer index. Requires SD_BINARY_CONVERSION
 - M42 P<pin number> S<value 0..255> - Change output of pin P to S. Does not work on most important pins.
 - M80  - Turn on power supply
 - M81  - Turn off power supply
@@ -144,6 +145,7 @@ Custom M Codes
 - M302 S<0 or 1> - allow cold extrusion. Without S parameter it will allow. S1 will allow, S0 will disallow.
 - M303 P<extruder/bed> S<printTemerature> X0 R<Repetitions> C<method>- Auto detect pid values. Use P<NUM_EXTRUDER> for heated bed. X0 saves result in EEPROM. R is number of cycles.
 				method 0 = classic, 1 = some overshoot, 2 = no overshoot, 3 = pessen, 4 = Tyreus-Lyben
+- M307 S<printTemperature> F<filament mm/s> X0 - Measure heater feed forward of active extruder while extruding with F mm/s. X0 saves result in EEPROM.
 - M320 S<0/1> - Activate auto level, S1 stores it in eeprom
 - M321 S<0/1> - Deactivate auto level, S1 stores it in eeprom
 - M322 - Reset auto level matrix
@@ -168,6 +170,8 @@ Custom M Codes
 - M530 S<printing> L<layer> - Enables explicit printing mode (S1) or disables it (S0). L can set layer count
 - M531 filename - Define filename being printed
 - M532 X<percent> L<curLayer> - update current print state progress (X=0..100) and layer L
+- M536 S<0> - Report stepper interrupt and planner timing statistics, S resets them. Requires DEBUG_STEPPER_TIMING
+- M537 S<0> - Report run time of the scheduler tasks, S resets them. Requires DEBUG_SCHEDULER_TIMING
 - M600 Change filament
 - M601 S<1/0> B<1/0> P<1/0> - Pause extruders. B1 also pauses heated bed. Paused extrudes disable heaters and motor. Continue (S0) reheats extruder to old temp. P0 does not wait for target temperature.
 - M602 S<1/0> P<1/0>- Debug jam control (S) Disable jam control (P). If enabled it will log signal changes and will not trigger jam errors!
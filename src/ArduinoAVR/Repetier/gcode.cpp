@@ -27,7 +27,17 @@
 #define FEATURE_CHECKSUM_FORCED false
 #endif
 
+#if GCODE_COMPACT_BUFFER
+GCode    GCode::commandsBuffered[2]; ///< Received command at 0, expanded command in execution at 1.
+uint8_t  GCode::compactBuffer[GCODE_COMPACT_BUFFER_BYTES]; ///< Buffered commands as compact records.
+uint16_t GCode::compactReadPos = 0; ///< Start of oldest record.
+uint16_t GCode::compactWritePos = 0; ///< Position for next record.
+uint16_t GCode::compactEndPos = 0; ///< End of records at buffer end, after writing wrapped around.
+bool     GCode::compactWrapped = false; ///< Writing continued at buffer start.
+bool     GCode::compactExpanded = false; ///< Record at compactReadPos is expanded into commandsBuffered[1].
+#else
 GCode    GCode::commandsBuffered[GCODE_BUFFER_SIZE]; ///< Buffer for received commands.
+#endif
 uint8_t  GCode::bufferReadIndex = 0; ///< Read position in gcode_buffer.
 uint8_t  GCode::bufferWriteIndex = 0; ///< Write position in gcode_buffer.
 uint8_t  GCode::commandReceiving[MAX_CMD_SIZE]; ///< Current received command.
@@ -69,6 +79,23 @@ all implemented features.
 - The new protocol send data in binary format. This reduces the data size to less then 50% and
   it speeds up decoding the command. No slow conversion from string to floats are needed.
 
+\subsection Frames
+
+Version 3 allows several binary commands in one frame, which is acknowledged with a single ok.
+A frame starts with the bitfield BINARY_FRAME_BITFIELD (bit 7 and bit 13 set) and has the layout
+
+- 2 byte bitfield 0x2080
+- 1 byte number of commands in frame
+- 1 byte length of following command data
+- command data: binary commands as described below, but without their own checksum
+- 2 byte fletcher-16 checksum over the complete frame
+
+The frame must fit into MAX_CMD_SIZE bytes and may not contain more commands than the command
+buffer has free entries. Commands with a text parameter can not be sent in a frame.
+A frame is acknowledged with "ok <last line number> B:<free command buffer entries>", so
+the host knows how many commands the next frame may contain. If a line number is wrong,
+a resend for the expected line is requested and the rest of the frame is ignored.
+
 */
 
 /** \brief Computes size of binary data from bitfield.
@@ -198,9 +225,10 @@ void GCode::requestResend()
 
 /**
   Check if result is plausible. If it is, an ok is send and the command is stored in queue.
-  If not, a resend and ok is send.
+  If not, a resend and ok is send. Without acknowledge the ok is left to the caller, which
+  is used for commands from a binary frame. Returns false if a resend was requested.
 */
-void GCode::checkAndPushCommand()
+bool GCode::checkAndPushCommand(bool acknowledge)
 {
     if(hasM())
     {
@@ -208,14 +236,15 @@ void GCode::checkAndPushCommand()
         {
 #if NEW_COMMUNICATION            
             GCodeSource::activeSource->lastLineNumber = actLineNumber;
-            Com::printFLN(Com::tOk);
+            if(acknowledge)
+                Com::printFLN(Com::tOk);
             GCodeSource::activeSource->waitingForResend = -1;
 #else
             lastLineNumber = actLineNumber;
             Com::printFLN(Com::tOk);
             waitingForResend = -1;
 #endif            
-            return;
+            return true;
         }
         if(M == 112)   // Emergency kill - freeze printer
         {
@@ -229,7 +258,7 @@ void GCode::checkAndPushCommand()
 #else            
             lastLineNumber++;
 #endif            
-            return;
+            return true;
         } else if(M == 668) {
 #if NEW_COMMUNICATION
             GCodeSource::activeSource->lastLineNumber = 0;  // simulate a reset so lines are out of resend buffer
@@ -256,7 +285,9 @@ void GCode::checkAndPushCommand()
                 // we have seen that line already. So we assume it is a repeated resend and we ignore it
                 commandsReceivingWritePosition = 0;
                 Com::printFLN(Com::tSkip,actLineNumber);
-                Com::printFLN(Com::tOk);
+                if(acknowledge)
+                    Com::printFLN(Com::tOk);
+                return true;
             }
 #if NEW_COMMUNICATION            
             else if(GCodeSource::activeSource->waitingForResend < 0)  // after a resend, we have to skip the garbage in buffers, no message for this
@@ -286,7 +317,7 @@ void GCode::checkAndPushCommand()
                 Com::printFLN(Com::tSkip, actLineNumber);
                 Com::printFLN(Com::tOk);
             }
-            return;
+            return false;
         }
 #if NEW_COMMUNICATION
         GCodeSource::activeSource->lastLineNumber = actLineNumber;
@@ -310,13 +341,15 @@ void GCode::checkAndPushCommand()
 	}
 #ifdef DEBUG_COM_ERRORS
     if(hasM() && M == 667)
-        return; // omit ok
+        return true; // omit ok
 #endif
+    if(acknowledge) {
 #if ACK_WITH_LINENUMBER
-    Com::printFLN(Com::tOkSpace, actLineNumber);
+        Com::printFLN(Com::tOkSpace, actLineNumber);
 #else
-    Com::printFLN(Com::tOk);
+        Com::printFLN(Com::tOk);
 #endif
+    }
 #if NEW_COMMUNICATION
     GCodeSource::activeSource->wasLastCommandReceivedAsBinary = sendAsBinary;
 	keepAlive(NotBusy);
@@ -326,17 +359,202 @@ void GCode::checkAndPushCommand()
 	keepAlive(NotBusy);
 	waitingForResend = -1; // everything is ok.
 #endif    
+    return true;
+}
+
+#if NEW_COMMUNICATION
+/** \brief Pushes all commands of a received binary frame and acknowledges them with one ok.
+
+The complete frame is in commandReceiving and binaryCommandSize is the frame size.
+*/
+void GCode::readBinaryFrame()
+{
+    if(!isBinaryChecksumValid(commandReceiving, binaryCommandSize))
+    {
+        if(Printer::debugErrors())
+            Com::printErrorFLN(Com::tWrongChecksum);
+        requestResend();
+        return;
+    }
+    uint8_t count = commandReceiving[2];
+    if(count > freeCommandSlots())
+    {
+        Com::printErrorFLN(PSTR("Frame exceeds free command buffer"));
+        requestResend();
+        return;
+    }
+    uint8_t *p = commandReceiving + 4;
+    uint8_t *end = p + commandReceiving[3];
+    while(count--)
+    {
+        uint8_t size = computeBinarySize((char*)p) - 2; // commands in frame have no checksum
+        if(p + size > end || (*(uint16_t*)p & 32768))   // no text commands, they would overwrite the next command
+        {
+            Com::printErrorFLN(Com::tFormatError);
+            requestResend();
+            return;
+        }
+        GCode *act = &commandsBuffered[bufferWriteIndex];
+        act->source = GCodeSource::activeSource;
+        act->parseBinary(p, true, false);
+        if(!act->checkAndPushCommand(false))
+            return; // resend requested, ignore rest of frame
+        p += size;
+    }
+    Com::printF(Com::tOkSpace, actLineNumber);
+    Com::printFLN(PSTR(" B:"), static_cast<int>(freeCommandSlots()));
 }
+#endif
 
 void GCode::pushCommand()
 {
 #if !ECHO_ON_EXECUTE
     commandsBuffered[bufferWriteIndex].echoCommand();
 #endif
+#if GCODE_COMPACT_BUFFER
+    GCode &act = commandsBuffered[0];
+    uint8_t size = act.compactSize();
+    if(!hasCompactSpace(size)) // readFromSerial only reads with enough space, so this should not happen
+    {
+        Com::printErrorFLN(PSTR("Command buffer overflow"));
+        return;
+    }
+    if(bufferLength == 0)
+    {
+        compactReadPos = compactWritePos = 0;
+        compactWrapped = false;
+    }
+    else if(!compactWrapped && GCODE_COMPACT_BUFFER_BYTES - compactWritePos < size)
+    {
+        compactEndPos = compactWritePos;
+        compactWritePos = 0;
+        compactWrapped = true;
+    }
+    act.storeCompact(&compactBuffer[compactWritePos]);
+    compactWritePos += size;
+    waitUntilAllCommandsAreParsed = false; // text is copied into record
+#else
     if(++bufferWriteIndex >= GCODE_BUFFER_SIZE) bufferWriteIndex = 0;
+#endif
     bufferLength++;
 }
 
+/** \brief Number of commands that can be received before the command buffer is full. */
+uint8_t GCode::freeCommandSlots()
+{
+    uint8_t slots = GCODE_BUFFER_SIZE - bufferLength;
+#if GCODE_COMPACT_BUFFER
+    // Worst case record size, so every reported slot is guaranteed to fit
+    uint16_t records;
+    if(bufferLength == 0)
+        records = GCODE_COMPACT_BUFFER_BYTES / GCODE_COMPACT_RECORD_MAX;
+    else if(compactWrapped)
+        records = (compactReadPos - compactWritePos) / GCODE_COMPACT_RECORD_MAX;
+    else
+        records = (GCODE_COMPACT_BUFFER_BYTES - compactWritePos) / GCODE_COMPACT_RECORD_MAX + compactReadPos / GCODE_COMPACT_RECORD_MAX;
+    if(records < slots)
+        slots = records;
+#endif
+    return slots;
+}
+
+#if GCODE_COMPACT_BUFFER
+/** \brief Tests if a record of size byte fits into the compact buffer. */
+bool GCode::hasCompactSpace(uint8_t size)
+{
+    if(bufferLength == 0)
+        return true;
+    if(compactWrapped)
+        return compactReadPos - compactWritePos >= size;
+    return GCODE_COMPACT_BUFFER_BYTES - compactWritePos >= size || compactReadPos >= size;
+}
+
+/** \brief Size of the compact record for this command.
+
+The record contains size byte, internal flag, source and the command in binary V2 format
+without checksum. Text is followed by an extra byte, where parseBinary terminates the string.
+*/
+uint8_t GCode::compactSize()
+{
+    uint8_t header[5];
+    *(uint16_t*)header = (params | 4096) & ~(8192 | 16384);
+    *(uint16_t*)(header + 2) = params2 & 2047;
+    header[4] = (hasString() ? RMath::min(static_cast<int>(strlen(text)), 79) : 0);
+#if NEW_COMMUNICATION
+    return 2 + sizeof(GCodeSource*) + computeBinarySize((char*)header) - 2 + (hasString() ? 1 : 0);
+#else
+    return 2 + computeBinarySize((char*)header) - 2 + (hasString() ? 1 : 0);
+#endif
+}
+
+/** \brief Writes this command as compact record to p. Order of values must match parseBinary. */
+void GCode::storeCompact(uint8_t *p)
+{
+    uint8_t *start = p;
+    p += 2; // size and flags get written at the end
+#if NEW_COMMUNICATION
+    memcpy(p, &source, sizeof(GCodeSource*));
+    p += sizeof(GCodeSource*);
+#endif
+    uint8_t textlen = (hasString() ? RMath::min(static_cast<int>(strlen(text)), 79) : 0);
+    *(uint16_t*)p = (params | 4096) & ~(8192 | 16384);
+    p += 2;
+    *(uint16_t*)p = params2 & 2047;
+    p += 2;
+    if(hasString())
+        *p++ = textlen;
+    if(hasN())
+    {
+        *(uint16_t*)p = N;
+        p += 2;
+    }
+    if(hasM())
+    {
+        *(uint16_t*)p = M;
+        p += 2;
+    }
+    if(hasG())
+    {
+        *(uint16_t*)p = G;
+        p += 2;
+    }
+    float *floats[5] = {&X, &Y, &Z, &E, &F};
+    uint16_t floatBits[5] = {8, 16, 32, 64, 256};
+    for(uint8_t i = 0; i < 5; i++)
+        if(params & floatBits[i])
+        {
+            memcpy(p, floats[i], 4);
+            p += 4;
+        }
+    if(hasT())
+        *p++ = T;
+    if(hasS())
+    {
+        memcpy(p, &S, 4);
+        p += 4;
+    }
+    if(hasP())
+    {
+        memcpy(p, &P, 4);
+        p += 4;
+    }
+    float *floats2[11] = {&I, &J, &R, &D, &C, &H, &A, &B, &K, &L, &O};
+    for(uint8_t i = 0; i < 11; i++)
+        if(params2 & (1 << i))
+        {
+            memcpy(p, floats2[i], 4);
+            p += 4;
+        }
+    if(hasString())
+    {
+        memcpy(p, text, textlen);
+        p += textlen + 1; // room for terminating 0
+    }
+    start[0] = p - start;
+    start[1] = internalCommand;
+}
+#endif
+
 /**
   Get the next buffered command. Returns 0 if no more commands are buffered. For each
   returned command, the gcode_command_finished() function must be called.
@@ -344,7 +562,32 @@ void GCode::pushCommand()
 GCode *GCode::peekCurrentCommand()
 {
     if(bufferLength == 0) return NULL; // No more data
+#if GCODE_COMPACT_BUFFER
+    if(!compactExpanded)
+    {
+        if(compactWrapped && compactReadPos == compactEndPos)
+        {
+            compactReadPos = 0;
+            compactWrapped = false;
+        }
+        uint8_t *p = &compactBuffer[compactReadPos];
+        GCode &act = commandsBuffered[1];
+        uint32_t lineNumber = actLineNumber; // parseBinary changes receiving state
+        bool waitParsed = waitUntilAllCommandsAreParsed;
+        uint8_t headerSize = 2;
+#if NEW_COMMUNICATION
+        memcpy(&act.source, p + 2, sizeof(GCodeSource*));
+        headerSize += sizeof(GCodeSource*);
+#endif
+        act.parseBinary(p + headerSize, !p[1], false);
+        actLineNumber = lineNumber;
+        waitUntilAllCommandsAreParsed = waitParsed;
+        compactExpanded = true;
+    }
+    return &commandsBuffered[1];
+#else
     return &commandsBuffered[bufferReadIndex];
+#endif
 }
 
 /** \brief Removes the last returned command from cache. */
@@ -354,7 +597,12 @@ void GCode::popCurrentCommand()
 #if ECHO_ON_EXECUTE
     echoCommand();
 #endif
+#if GCODE_COMPACT_BUFFER
+    compactReadPos += compactBuffer[compactReadPos];
+    compactExpanded = false;
+#else
     if(++bufferReadIndex == GCODE_BUFFER_SIZE) bufferReadIndex = 0;
+#endif
     bufferLength--;
 }
 
@@ -438,7 +686,7 @@ void GCode::readFromSerial()
 		return; // do nothing while door is open
 	}
 #endif	
-    if(bufferLength >= GCODE_BUFFER_SIZE || (waitUntilAllCommandsAreParsed && bufferLength)) {
+    if(freeCommandSlots() == 0 || (waitUntilAllCommandsAreParsed && bufferLength)) {
 		keepAlive(Processing);
 		return; // all buffers full
 	}
@@ -503,8 +751,20 @@ void GCode::readFromSerial()
         if(sendAsBinary)
         {
             if(commandsReceivingWritePosition < 2 ) continue;
-            if(commandsReceivingWritePosition == 5 || commandsReceivingWritePosition == 4)
-            binaryCommandSize = computeBinarySize((char*)commandReceiving);
+            bool isFrame = *(uint16_t*)commandReceiving == BINARY_FRAME_BITFIELD;
+            if(commandsReceivingWritePosition == 5 || commandsReceivingWritePosition == 4) {
+                if(isFrame)
+                    binaryCommandSize = RMath::min(static_cast<int>(commandReceiving[3]) + 6, MAX_CMD_SIZE);
+                else
+                    binaryCommandSize = computeBinarySize((char*)commandReceiving);
+            }
+            if(isFrame && commandsReceivingWritePosition == binaryCommandSize)
+            {
+                readBinaryFrame();
+                GCodeSource::rotateSource();
+                Com::writeToAll = lastWTA;
+                return;
+            }
             if(commandsReceivingWritePosition == binaryCommandSize)
             {
                 GCode *act = &commandsBuffered[bufferWriteIndex];
@@ -749,18 +1009,14 @@ void GCode::readFromSerial()
 #endif
 }
 
-/**
-  Converts a binary uint8_tfield containing one GCode line into a GCode structure.
-  Returns true if checksum was correct.
-*/
-bool GCode::parseBinary(uint8_t *buffer,bool fromSerial)
+/** \brief Tests the fletcher-16 checksum stored in the last 2 bytes of a binary command or frame. */
+bool GCode::isBinaryChecksumValid(uint8_t *buffer,uint8_t size)
 {
-    internalCommand = !fromSerial;
     unsigned int sum1 = 0, sum2 = 0; // for fletcher-16 checksum
     // first do fletcher-16 checksum tests see
     // http://en.wikipedia.org/wiki/Fletcher's_checksum
     uint8_t *p = buffer;
-    uint8_t len = binaryCommandSize - 2;
+    uint8_t len = size - 2;
     while (len)
     {
         uint8_t tlen = len > 21 ? 21 : len;
@@ -776,7 +1032,17 @@ bool GCode::parseBinary(uint8_t *buffer,bool fromSerial)
     }
     sum1 -= *p++;
     sum2 -= *p;
-    if(sum1 | sum2)
+    return (sum1 | sum2) == 0;
+}
+
+/**
+  Converts a binary uint8_tfield containing one GCode line into a GCode structure.
+  Returns true if checksum was correct. Commands from a binary frame have no own checksum.
+*/
+bool GCode::parseBinary(uint8_t *buffer,bool fromSerial,bool verifyChecksum)
+{
+    internalCommand = !fromSerial;
+    if(verifyChecksum && !isBinaryChecksumValid(buffer, binaryCommandSize))
     {
         if(Printer::debugErrors())
         {
@@ -784,7 +1050,7 @@ bool GCode::parseBinary(uint8_t *buffer,bool fromSerial)
         }
         return false;
     }
-    p = buffer;
+    uint8_t *p = buffer;
     params = *(uint16_t *)p;
     p += 2;
     uint8_t textlen = 16;
@@ -930,6 +1196,59 @@ bool GCode::parseBinary(uint8_t *buffer,bool fromSerial)
     return true;
 }
 
+/**
+  \brief Parses a number in [-]digits[.digits] format as written by slicers.
+
+  Digits get collected into an integer mantissa, that is divided by the power of ten
+  of the fractional digits. Mantissa and divisor are exact, so the single rounding of
+  the division gives the correctly rounded value. avr-libc strtod does not always round
+  correctly, so on AVR results are within 1 ulp of it. Numbers with exponent, hex prefix,
+  inf/nan or more digits than fit exactly are passed to strtod.
+*/
+float GCode::parseFloatValue(char *s)
+{
+    while(*s == 32) s++; // skip spaces
+    char *p = s;
+    bool negative = false;
+    if(*p == '-' || *p == '+')
+        negative = (*p++ == '-');
+    uint32_t mantissa = 0;
+    uint8_t digits = 0, fractionDigits = 0;
+    while(*p >= '0' && *p <= '9')
+    {
+        mantissa = mantissa * 10 + (*p++ - '0');
+        if(++digits > 9) break;
+    }
+    if(*p == '.')
+    {
+        p++;
+        while(*p >= '0' && *p <= '9' && digits <= 9)
+        {
+            mantissa = mantissa * 10 + (*p++ - '0');
+            digits++;
+            fractionDigits++;
+        }
+    }
+    char c = *p;
+    if(digits == 0 || digits > 9 || (c >= '0' && c <= '9') || c == 'e' || c == 'E' || c == 'x' || c == 'X' ||
+            (sizeof(double) == 4 && mantissa > 16777216UL))   // not exact or not our format
+    {
+        char *endPtr;
+        float f = (strtod(s, &endPtr));
+        if(s == endPtr) f = 0.0; // treat empty string "x " as "x0"
+        return f;
+    }
+    double f = static_cast<double>(mantissa);
+    if(fractionDigits)
+    {
+        double divisor = 10.0; // powers of ten up to 1e10 are exact, also for 32 bit double on AVR
+        while(--fractionDigits)
+            divisor *= 10.0;
+        f /= divisor;
+    }
+    return negative ? -f : f;
+}
+
 /**
   Converts a ASCII GCode line into a GCode structure.
 */
@@ -969,7 +1288,7 @@ bool GCode::parseAscii(char *line,bool fromSerial)
             params |= 2;
             if(M > 255) params |= 4096;
             // handle non standard text arguments that some M codes have
-            if (M == 20 || M == 23 || M == 28 || M == 29 || M == 30 || M == 32 || M == 36 || M == 117 || M == 531)
+            if (M == 20 || M == 23 || M == 28 || M == 29 || M == 30 || M == 32 || M == 35 || M == 36 || M == 117 || M == 531)
             {
                 // after M command we got a filename or text
                 char digit;
@@ -1473,6 +1792,14 @@ bool SDCardGCodeSource::dataAvailable() { // would read return a new byte?
     return false;
 }
 int SDCardGCodeSource::readByte() {
+#if SD_READ_AHEAD_BLOCKS
+    int n = sd.readAheadByte();
+    if(n == -1) {
+        Com::printErrorFLN(PSTR("SD error did not recover!"));
+        close();
+        return 0;
+    }
+#else
     int n = sd.file.read();
     if(n == -1) {
         Com::printFLN(Com::tSDReadError);
@@ -1488,6 +1815,7 @@ int SDCardGCodeSource::readByte() {
         }
         UI_ERROR("SD error fixed");
     }
+#endif
     sd.sdpos++; // = file.curPosition();
     return n;
 }
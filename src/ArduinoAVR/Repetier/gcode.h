@@ -19,6 +19,10 @@
 #define _GCODE_H
 
 #define MAX_CMD_SIZE 96
+/** Bitfield of a binary frame containing several binary commands (bit 7 + bit 13). */
+#define BINARY_FRAME_BITFIELD 0x2080
+/** Largest compact record: size, flags, source, V2 binary command and 79 byte text with terminator. */
+#define GCODE_COMPACT_RECORD_MAX (2 + sizeof(void*) + 87 + 81)
 #define ARRAY_SIZE(_x)	(sizeof(_x)/sizeof(_x[0]))
 
 enum FirmwareState {NotBusy=0,Processing,Paused,WaitHeater,DoorOpen};
@@ -247,7 +251,7 @@ public:
         return ((params2 & 32768)!=0);
     }
     void printCommand();
-    bool parseBinary(uint8_t *buffer,bool fromSerial);
+    bool parseBinary(uint8_t *buffer,bool fromSerial,bool verifyChecksum = true);
     bool parseAscii(char *line,bool fromSerial);
     void popCurrentCommand();
     void echoCommand();
@@ -258,6 +262,8 @@ public:
     static void pushCommand();
     static void executeFString(FSTRINGPARAM(cmd));
     static uint8_t computeBinarySize(char *ptr);
+    static bool isBinaryChecksumValid(uint8_t *buffer,uint8_t size);
+    static uint8_t freeCommandSlots();
 	static void fatalError(FSTRINGPARAM(message));
 	static void reportFatalError();
 	static void resetFatalError();
@@ -272,16 +278,12 @@ public:
     friend class GCodeSource;    
 protected:
     void debugCommandBuffer();
-    void checkAndPushCommand();
+    bool checkAndPushCommand(bool acknowledge = true);
     static void requestResend();
-    inline float parseFloatValue(char *s)
-    {
-        char *endPtr;
-        while(*s == 32) s++; // skip spaces
-        float f = (strtod(s, &endPtr));
-        if(s == endPtr) f=0.0; // treat empty string "x " as "x0"
-        return f;
-    }
+#if NEW_COMMUNICATION
+    static void readBinaryFrame();
+#endif
+    float parseFloatValue(char *s);
     inline long parseLongValue(char *s)
     {
         char *endPtr;
@@ -291,7 +293,20 @@ protected:
         return l;
     }
 
+#if GCODE_COMPACT_BUFFER
+    uint8_t compactSize();
+    void storeCompact(uint8_t *p);
+    static bool hasCompactSpace(uint8_t size);
+    static GCode commandsBuffered[2]; ///< Received command at 0, expanded command in execution at 1.
+    static uint8_t compactBuffer[GCODE_COMPACT_BUFFER_BYTES]; ///< Buffered commands as compact records.
+    static uint16_t compactReadPos; ///< Start of oldest record.
+    static uint16_t compactWritePos; ///< Position for next record.
+    static uint16_t compactEndPos; ///< End of records at buffer end, after writing wrapped around.
+    static bool compactWrapped; ///< Writing continued at buffer start.
+    static bool compactExpanded; ///< Record at compactReadPos is expanded into commandsBuffered[1].
+#else
     static GCode commandsBuffered[GCODE_BUFFER_SIZE]; ///< Buffer for received commands.
+#endif
     static uint8_t bufferReadIndex; ///< Read position in gcode_buffer.
     static uint8_t bufferWriteIndex; ///< Write position in gcode_buffer.
     static uint8_t commandReceiving[MAX_CMD_SIZE]; ///< Current received command.
@@ -84,6 +84,9 @@ PrintLine *PrintLine::cur = NULL;               ///< Current printing line
 volatile bool PrintLine::nlFlag = false;
 #endif
 ufast8_t PrintLine::linesWritePos = 0;            ///< Position where we write the next cached line move.
+#if CPU_ARCH == ARCH_ARM
+ufast8_t PrintLine::linesMax = PRINTLINE_CACHE_SIZE; ///< Used queue length, at most PRINTLINE_CACHE_SIZE.
+#endif
 volatile ufast8_t PrintLine::linesCount = 0;      ///< Number of lines cached 0 = nothing to do.
 ufast8_t PrintLine::linesPos = 0;                 ///< Position for executing line movement.
 
@@ -259,7 +262,7 @@ void PrintLine::queueCartesianSegmentTo(uint8_t check_endstops, uint8_t pathOpti
     if((p->isXYZMove()) && ((p->dir & XYZ_DIRPOS) ^ (Printer::backlashDir & XYZ_DIRPOS)) & (Printer::backlashDir >> 3)) { // We need to compensate backlash, add a move
         PrintLine::waitForXFreeLines(2);
         uint8_t wpos2 = PrintLine::linesWritePos + 1;
-        if(wpos2 >= PRINTLINE_CACHE_SIZE) wpos2 = 0;
+        if(wpos2 >= PRINTLINE_QUEUE_LENGTH) wpos2 = 0;
         PrintLine *p2 = &PrintLine::lines[wpos2];
         memcpy(p2, p, sizeof(PrintLine)); // Move current data to p2
         uint8_t changed = (p->dir & XYZ_DIRPOS) ^ (Printer::backlashDir & XYZ_DIRPOS);
@@ -413,7 +416,7 @@ void PrintLine::queueCartesianMove(uint8_t check_endstops, uint8_t pathOptimize)
     if((p->isXYZMove()) && ((p->dir & XYZ_DIRPOS) ^ (Printer::backlashDir & XYZ_DIRPOS)) & (Printer::backlashDir >> 3)) { // We need to compensate backlash, add a move
         waitForXFreeLines(2);
         uint8_t wpos2 = linesWritePos + 1;
-        if(wpos2 >= PRINTLINE_CACHE_SIZE) wpos2 = 0;
+        if(wpos2 >= PRINTLINE_QUEUE_LENGTH) wpos2 = 0;
         PrintLine *p2 = &lines[wpos2];
         memcpy(p2, p, sizeof(PrintLine)); // Move current data to p2
         uint8_t changed = (p->dir & XYZ_DIRPOS) ^ (Printer::backlashDir & XYZ_DIRPOS);
@@ -465,10 +468,15 @@ void PrintLine::queueCartesianMove(uint8_t check_endstops, uint8_t pathOptimize)
 #endif
 
 void PrintLine::calculateMove(float axisDistanceMM[], uint8_t pathOptimize, fast8_t drivingAxis) {
+#ifdef DEBUG_STEPPER_TIMING
+    uint32_t plannerStart = HAL::timeInMicroseconds();
+#endif
+#if !PLANNER_FAST_MATH
 #if NONLINEAR_SYSTEM
     long axisInterval[VIRTUAL_AXIS_ARRAY]; // shortest interval possible for that axis
 #else
     long axisInterval[E_AXIS_ARRAY];
+#endif
 #endif
     //float timeForMove = (float)(F_CPU)*distance / (isXOrYMove() ? RMath::max(Printer::minimumSpeed, Printer::feedrate) : Printer::feedrate); // time is in ticks
     float timeForMove = (float)(F_CPU) * distance / Printer::feedrate; // time is in ticks
@@ -482,6 +490,52 @@ void PrintLine::calculateMove(float axisDistanceMM[], uint8_t pathOptimize, fast
     }
     timeInTicks = timeForMove;
     UI_MEDIUM; // do check encoder
+#if PLANNER_FAST_MATH
+    // An axis limits if it needs more time than the move at feedrate: d > t * vmax. Only then we divide.
+    float timeS = timeForMove * (1.0f / F_CPU);
+    bool limited = false;
+#if NONLINEAR_SYSTEM && !defined(FAST_COREXYZ)
+    for(fast8_t i = E_AXIS; i < E_AXIS_ARRAY; i++) { // towers are limited by the virtual axis
+#else
+    for(fast8_t i = 0; i < E_AXIS_ARRAY; i++) {
+#endif
+        if(isMoveOfAxis(i) && axisDistanceMM[i] > timeS * Printer::maxFeedrate[i]) {
+            timeS = axisDistanceMM[i] / Printer::maxFeedrate[i];
+            limited = true;
+        }
+    }
+#if DRIVE_SYSTEM == DELTA
+    if(axisDistanceMM[VIRTUAL_AXIS] > timeS * Printer::maxFeedrate[Z_AXIS]) { // negative for pure extruder moves
+        timeS = axisDistanceMM[VIRTUAL_AXIS] / Printer::maxFeedrate[Z_AXIS];
+        limited = true;
+    }
+#endif
+    int32_t limitInterval = (limited ? timeS * static_cast<float>(F_CPU) : timeForMove) / stepsRemaining;
+    if(limitInterval < LIMIT_INTERVAL) {
+        limitInterval = LIMIT_INTERVAL;
+        limited = true;
+    }
+    fullInterval = limitInterval; // This is our target speed
+    if(limited)
+        timeForMove = (float)limitInterval * (float)stepsRemaining;
+    float inverseTimeS = (float)F_CPU / timeForMove;
+    if(isXMove()) {
+        speedX = axisDistanceMM[X_AXIS] * inverseTimeS;
+        if(isXNegativeMove()) speedX = -speedX;
+    } else speedX = 0;
+    if(isYMove()) {
+        speedY = axisDistanceMM[Y_AXIS] * inverseTimeS;
+        if(isYNegativeMove()) speedY = -speedY;
+    } else speedY = 0;
+    if(isZMove()) {
+        speedZ = axisDistanceMM[Z_AXIS] * inverseTimeS;
+        if(isZNegativeMove()) speedZ = -speedZ;
+    } else speedZ = 0;
+    if(isEMove()) {
+        speedE = axisDistanceMM[E_AXIS] * inverseTimeS;
+        if(isENegativeMove()) speedE = -speedE;
+    } else speedE = 0;
+#else
     // Compute the slowest allowed interval (ticks/step), so maximum feedrate is not violated
     int32_t limitInterval0;
     int32_t limitInterval = limitInterval0 = timeForMove / stepsRemaining; // until not violated by other constraints it is your target speed
@@ -543,6 +597,7 @@ void PrintLine::calculateMove(float axisDistanceMM[], uint8_t pathOptimize, fast
 #if NONLINEAR_SYSTEM
     axisInterval[VIRTUAL_AXIS] = limitInterval; //timeForMove/stepsRemaining;
 #endif
+#endif // PLANNER_FAST_MATH
     fullSpeed = distance * inverseTimeS;
     //long interval = axis_interval[primary_axis]; // time for every step in ticks with full speed
     //If acceleration is enabled, do some Bresenham calculations depending on which axis will lead it.
@@ -569,11 +624,23 @@ void PrintLine::calculateMove(float axisDistanceMM[], uint8_t pathOptimize, fast
     newAccel[E_AXIS] = accel[E_AXIS];
     accel = newAccel;
 #endif // INTERPOLATE_ACCELERATION_WITH_Z
+#if PLANNER_FAST_MATH
+    // Interval of axis i is timeForMove / delta[i], so the lowest accel[i] / delta[i] limits.
+    // Compare a_i * d_k < a_k * d_i and divide once for the found axis.
+    fast8_t slowestAxis = E_AXIS;
+    for(fast8_t i = 0; i < E_AXIS_ARRAY ; i++) {
+        if(isMoveOfAxis(i) && (!isMoveOfAxis(slowestAxis) || (float)accel[i] * (float)delta[slowestAxis] < (float)accel[slowestAxis] * (float)delta[i]))
+            slowestAxis = i;
+    }
+    float accelPerStep = (float)accel[slowestAxis] / (float)delta[slowestAxis];
+    slowestAxisPlateauTimeRepro = timeForMove * accelPerStep;
+#else
     for(fast8_t i = 0; i < E_AXIS_ARRAY ; i++) {
         if(isMoveOfAxis(i))
             // v = a * t => t = v/a = F_CPU/(c*a) => 1/t = c*a/F_CPU
             slowestAxisPlateauTimeRepro = RMath::min(slowestAxisPlateauTimeRepro, (float)axisInterval[i] * (float)accel[i]); //  steps/s^2 * step/tick  Ticks/s^2
     }
+#endif
 
     // Errors for delta move are initialized in timer (except extruder)
 #if !NONLINEAR_SYSTEM
@@ -583,10 +650,16 @@ void PrintLine::calculateMove(float axisDistanceMM[], uint8_t pathOptimize, fast
     error[E_AXIS] = stepsRemaining >> 1;
 #endif
     invFullSpeed = 1.0 / fullSpeed;
+#if PLANNER_FAST_MATH
+    accelerationPrim = accelPerStep * stepsRemaining; // interval of primary axis is timeForMove / stepsRemaining
+    fAcceleration = (262144.0f / F_CPU) * (float)accelerationPrim;
+    accelerationDistance2 = (2.0f / F_CPU) * distance * slowestAxisPlateauTimeRepro * fullSpeed; // mm^2/s^2
+#else
     accelerationPrim = slowestAxisPlateauTimeRepro / axisInterval[primaryAxis]; // a = v/t = F_CPU/(c*t): Steps/s^2
     //Now we can calculate the new primary axis acceleration, so that the slowest axis max acceleration is not violated
     fAcceleration = 262144.0 * (float)accelerationPrim / F_CPU; // will overflow without float!
     accelerationDistance2 = 2.0 * distance * slowestAxisPlateauTimeRepro * fullSpeed / ((float)F_CPU); // mm^2/s^2
+#endif
     startSpeed = endSpeed = minSpeed = safeSpeed(drivingAxis);
     if(startSpeed > Printer::feedrate)
         startSpeed = endSpeed = minSpeed = Printer::feedrate;
@@ -650,6 +723,9 @@ void PrintLine::calculateMove(float axisDistanceMM[], uint8_t pathOptimize, fast
         Com::printFLN(Com::tDBGCommandedFeedrate, Printer::feedrate);
         Com::printFLN(Com::tDBGConstFullSpeedMoveTime, timeForMove);
     }
+#endif
+#ifdef DEBUG_STEPPER_TIMING
+    Printer::updatePlannerTiming(HAL::timeInMicroseconds() - plannerStart);
 #endif
     // Make result permanent
     if (pathOptimize) waitRelax = 70;
@@ -681,11 +757,8 @@ void PrintLine::updateTrapezoids() {
     // Now ignore enough segments to gain enough time for path planning
     millis_t timeleft = 0;
     // Skip as many stored moves as needed to gain enough time for computation
-#if PRINTLINE_CACHE_SIZE < 10
-#define minTime 4500L * PRINTLINE_CACHE_SIZE
-#else
-#define minTime 45000L
-#endif
+    // With a short queue less time is available, linesMax is set at runtime on ARM
+    const millis_t minTime = PRINTLINE_QUEUE_LENGTH < 10 ? 4500L * PRINTLINE_QUEUE_LENGTH : 45000L;
     while(timeleft < minTime && maxfirst != linesWritePos) {
         timeleft += lines[maxfirst].timeInTicks;
         nextPlannerIndex(maxfirst);
@@ -739,9 +812,9 @@ void PrintLine::updateTrapezoids() {
         computeMaxJunctionSpeed(previous, act); // Set maximum junction speed if we have a real move before
     }
     // Increase speed if possible neglecting current speed
-    backwardPlanner(linesWritePos, first);
-    // Reduce speed to reachable speeds
-    forwardPlanner(first);
+    ufast8_t changed = backwardPlanner(linesWritePos, first);
+    // Reduce speed to reachable speeds. Lines before changed keep their speeds.
+    forwardPlanner(changed);
 
 #ifdef DEBUG_PLANNER
     if(Printer::debugEcho()) {
@@ -755,7 +828,14 @@ void PrintLine::updateTrapezoids() {
     }
 #endif
     // Update precomputed data
+#ifdef DEBUG_STEPPER_TIMING
+    ufast8_t replanned = 1; // act is always computed
+#endif
     do {
+#ifdef DEBUG_STEPPER_TIMING
+        if(!lines[first].areParameterUpToDate())
+            replanned++;
+#endif
         lines[first].updateStepsParameter();
 #ifdef DEBUG_PLANNER
         if(Printer::debugEcho()) {
@@ -776,6 +856,9 @@ void PrintLine::updateTrapezoids() {
     } while(first != linesWritePos);
     act->updateStepsParameter();
     act->unblock();
+#ifdef DEBUG_STEPPER_TIMING
+    Printer::updateReplanTiming(replanned);
+#endif
 #ifdef DEBUG_PLANNER
     if(Printer::debugEcho()) {
         Com::printF(PSTR(" / "), lines[first].startSpeed, 1);
@@ -855,7 +938,7 @@ inline void PrintLine::computeMaxJunctionSpeed(PrintLine *previous, PrintLine *c
     float dx = current->speedX - previous->speedX;
     float dy = current->speedY - previous->speedY;
     float dz = current->speedZ - previous->speedZ;
-    float jerk = sqrt(dx * dx + dy * dy + dz * dz) * lengthFactor;
+    float jerk2 = (dx * dx + dy * dy + dz * dz) * lengthFactor * lengthFactor;
 #endif // ALTERNATIVE_JERK
 #else // DELTA
 #ifdef ALTERNATIVE_JERK
@@ -863,10 +946,17 @@ inline void PrintLine::computeMaxJunctionSpeed(PrintLine *previous, PrintLine *c
 #else
     float dx = current->speedX - previous->speedX;
     float dy = current->speedY - previous->speedY;
-    float jerk = sqrt(dx * dx + dy * dy) * lengthFactor;
+    float jerk2 = (dx * dx + dy * dy) * lengthFactor * lengthFactor;
 #endif // ALTERNATIVE_JERK
 #endif // DELTA
+#ifdef ALTERNATIVE_JERK
     if(jerk > Printer::maxJerk) {
+#else
+    // Compare squared jerk, so the square root is only needed if jerk gets limited.
+    // Within rounding of the squares this decides like comparing sqrt(jerk2).
+    if(jerk2 > Printer::maxJerk * Printer::maxJerk) {
+        float jerk = sqrt(jerk2);
+#endif
         factor = Printer::maxJerk / jerk; // always < 1.0!
         if(factor * maxJoinSpeed * 2.0 < Printer::maxJerk)
             factor = Printer::maxJerk / (2.0 * maxJoinSpeed);
@@ -923,6 +1013,9 @@ void PrintLine::updateStepsParameter() {
         accelSteps = accelSteps - RMath::min(static_cast<int32_t>(accelSteps), static_cast<int32_t>(red));
         decelSteps = decelSteps - RMath::min(static_cast<int32_t>(decelSteps), static_cast<int32_t>(red));
     }
+#if STEP_RAMP_TABLE
+    computeRampTables();
+#endif
     setParameterUpToDate();
 #ifdef DEBUG_QUEUE_MOVE
     if(Printer::debugEcho()) {
@@ -940,16 +1033,62 @@ void PrintLine::updateStepsParameter() {
 #endif
 }
 
+#if STEP_RAMP_TABLE
+/** Fill the speed band tables used by the stepper interrupt.
+
+Acceleration and deceleration are split into STEP_RAMP_TABLE_SIZE bands of equal speed change.
+Band limits are computed in steps (s = (v^2-v0^2)/(2*a)) and each band runs with the interval of its mean speed.
+If steps or intervals do not fit into 16 bit, the line uses the computed ramp in the interrupt.
+*/
+void PrintLine::computeRampTables() {
+    flags &= ~FLAG_RAMP_TABLE;
+    if(accelSteps > 65000 || decelSteps > 65000)
+        return;
+    float minSpeed = static_cast<float>(F_CPU) / 65535.0f; // slower speeds overflow interval
+    float vs = vStart;
+    float ve = vEnd;
+    if(vs < minSpeed || ve < minSpeed)
+        return;
+    float a2 = 2.0f * static_cast<float>(accelerationPrim);
+    float vPeak = RMath::min(static_cast<float>(vMax), static_cast<float>(sqrt(vs * vs + a2 * static_cast<float>(accelSteps))));
+    float dv = (vPeak - vs) / STEP_RAMP_TABLE_SIZE;
+    float v = vs, vNext;
+    for(fast8_t i = 0; i < STEP_RAMP_TABLE_SIZE; i++) {
+        vNext = v + dv;
+        accelRampSteps[i] = static_cast<uint16_t>((vNext * vNext - vs * vs) / a2);
+        accelRampInterval[i] = static_cast<uint16_t>(static_cast<float>(F_CPU) / (v + 0.5f * dv));
+        v = vNext;
+    }
+    accelRampSteps[STEP_RAMP_TABLE_SIZE - 1] = 65535; // last band lasts until acceleration ends
+    vPeak = RMath::min(static_cast<float>(vMax), static_cast<float>(sqrt(ve * ve + a2 * static_cast<float>(decelSteps))));
+    dv = (vPeak - ve) / STEP_RAMP_TABLE_SIZE;
+    v = vPeak;
+    for(fast8_t i = 0; i < STEP_RAMP_TABLE_SIZE; i++) {
+        vNext = v - dv;
+        decelRampSteps[i] = static_cast<uint16_t>((vNext * vNext - ve * ve) / a2);
+        decelRampInterval[i] = static_cast<uint16_t>(static_cast<float>(F_CPU) / (v - 0.5f * dv));
+        v = vNext;
+    }
+    decelRampSteps[STEP_RAMP_TABLE_SIZE - 1] = 0; // last band lasts until move ends
+    flags |= FLAG_RAMP_TABLE;
+}
+#endif
+
 /**
 Compute the maximum speed from the last entered move.
 The backwards planner traverses the moves from last to first looking at deceleration. The RHS of the accelerate/decelerate ramp.
 
+If a junction keeps its speed from the last run, all lines before it keep their speeds as well,
+so the pass stops there.
+
 start = last line inserted
 last = last element until we check
+returns index of the first line the forward planner needs to update
 */
-inline void PrintLine::backwardPlanner(ufast8_t start, ufast8_t last) {
+inline ufast8_t PrintLine::backwardPlanner(ufast8_t start, ufast8_t last) {
     PrintLine *act = &lines[start], *previous;
     float lastJunctionSpeed = act->endSpeed; // Start always with safe speed
+    float newSpeed;
 
     //PREVIOUS_PLANNER_INDEX(last); // Last element is already fixed in start speed
     while(start != last) {
@@ -976,26 +1115,41 @@ inline void PrintLine::backwardPlanner(ufast8_t start, ufast8_t last) {
         lastJunctionSpeed = (act->isNominalMove() ? act->fullSpeed : sqrt(lastJunctionSpeed * lastJunctionSpeed + act->accelerationDistance2)); // acceleration is acceleration*distance*2! What can be reached if we try?
         // If that speed is more that the maximum junction speed allowed then ...
         if(lastJunctionSpeed >= previous->maxJunctionSpeed) { // Limit is reached
+            bool unchanged = true;
             // If the previous line's end speed has not been updated to maximum speed then do it now
             if(previous->endSpeed != previous->maxJunctionSpeed) {
                 previous->invalidateParameter(); // Needs recomputation
                 previous->endSpeed = RMath::max(previous->minSpeed, previous->maxJunctionSpeed); // possibly unneeded???
+                unchanged = false;
             }
             // If actual line start speed has not been updated to maximum speed then do it now
             if(act->startSpeed != previous->maxJunctionSpeed) {
                 act->startSpeed = RMath::max(act->minSpeed, previous->maxJunctionSpeed); // possibly unneeded???
                 act->invalidateParameter();
             }
+            if(unchanged) { // Same junction speed as last run, so nothing before changes
+                nextPlannerIndex(start);
+                return start;
+            }
             lastJunctionSpeed = previous->endSpeed;
         } else {
             // Block previous end and act start as calculated speed and recalculate plateau speeds (which could move the speed higher again)
-            act->startSpeed = RMath::max(act->minSpeed, lastJunctionSpeed);
-            lastJunctionSpeed = previous->endSpeed = RMath::max(lastJunctionSpeed, previous->minSpeed);
+            newSpeed = RMath::max(act->minSpeed, lastJunctionSpeed);
+            if(act->startSpeed != newSpeed) {
+                act->startSpeed = newSpeed;
+                act->invalidateParameter();
+            }
+            newSpeed = RMath::max(lastJunctionSpeed, previous->minSpeed);
+            if(previous->endSpeed == newSpeed) { // Same junction speed as last run, so nothing before changes
+                nextPlannerIndex(start);
+                return start;
+            }
+            lastJunctionSpeed = previous->endSpeed = newSpeed;
             previous->invalidateParameter();
-            act->invalidateParameter();
         }
         act = previous;
     } // while loop
+    return last;
 }
 
 void PrintLine::forwardPlanner(ufast8_t first) {
@@ -1003,10 +1157,13 @@ void PrintLine::forwardPlanner(ufast8_t first) {
     PrintLine *next = &lines[first];
     float vmaxRight;
     float leftSpeed = next->startSpeed;
+    float oldStart, oldEnd;
     while(first != linesWritePos) { // All except last segment, which has fixed end speed
         act = next;
         nextPlannerIndex(first);
         next = &lines[first];
+        oldStart = act->startSpeed;
+        oldEnd = act->endSpeed;
         /* if(act->isEndSpeedFixed())
          {
              leftSpeed = act->endSpeed;
@@ -1036,10 +1193,8 @@ void PrintLine::forwardPlanner(ufast8_t first) {
                 act->setEndSpeedFixed(true);
                 next->setStartSpeedFixed(true);
             }
-            act->invalidateParameter();
         } else { // We can accelerate full speed without reaching limit, which is as fast as possible. Fix it!
             act->fixStartAndEndSpeed();
-            act->invalidateParameter();
             if(act->minSpeed > leftSpeed) {
                 leftSpeed = act->minSpeed;
                 vmaxRight = sqrt(leftSpeed * leftSpeed + act->accelerationDistance2);
@@ -1049,6 +1204,8 @@ void PrintLine::forwardPlanner(ufast8_t first) {
             next->startSpeed = leftSpeed = RMath::max(RMath::min(act->endSpeed, act->maxJunctionSpeed), next->minSpeed);
             next->setStartSpeedFixed(true);
         }
+        if(act->startSpeed != oldStart || act->endSpeed != oldEnd)
+            act->invalidateParameter();
     } // While
     next->startSpeed = RMath::max(next->minSpeed, leftSpeed); // This is the new segment, which is updated anyway, no extra flag needed.
 }
@@ -1154,13 +1311,50 @@ void PrintLine::logLine() {
 #endif // DEBUG_QUEUE_MOVE
 }
 
+#if CPU_ARCH == ARCH_ARM
+/** Changes the number of used lines in the move queue. Waits for all moves to finish, as the
+ring positions are only valid for one length. */
+void PrintLine::setQueueLength(int16_t length) {
+    if(length < 5) length = 5;
+    if(length > PRINTLINE_CACHE_SIZE) length = PRINTLINE_CACHE_SIZE;
+    if(length == static_cast<int16_t>(linesMax)) return;
+    Commands::waitUntilEndOfAllMoves();
+    InterruptProtectedBlock noInts;
+    linesMax = length;
+    linesPos = linesWritePos = 0;
+}
+#endif
+
 void PrintLine::waitForXFreeLines(uint8_t b, bool allowMoves) {
-    while(getLinesCount() + b > PRINTLINE_CACHE_SIZE) { // wait for a free entry in movement cache
+    while(getLinesCount() + b > PRINTLINE_QUEUE_LENGTH) { // wait for a free entry in movement cache
         //GCode::readFromSerial();
         Commands::checkForPeriodicalActions(allowMoves);
     }
 }
 
+/** Mean filament speed in mm/s of all queued moves, weighted with their duration.
+Retractions count as no extrusion. Used as heater feed forward.
+*/
+float PrintLine::queuedExtrusionSpeed() {
+    ufast8_t p, n;
+    {
+        InterruptProtectedBlock noInts;
+        p = linesPos;
+        n = linesCount;
+    }
+    float extruded = 0, time = 0;
+    while(n--) {
+        PrintLine &l = lines[p];
+        if(!l.isWarmUp()) {
+            time += l.timeInTicks;
+            if(l.speedE > 0)
+                extruded += l.speedE * l.timeInTicks;
+        }
+        nextPlannerIndex(p);
+    }
+    return time > 0 ? extruded / time : 0;
+}
+
 #ifdef FAST_COREXYZ
 uint8_t transformCartesianStepsToDeltaSteps(int32_t cartesianPosSteps[], int32_t corePosSteps[]) {
 #if DRIVE_SYSTEM == XY_GANTRY
@@ -1203,6 +1397,49 @@ uint8_t transformCartesianStepsToDeltaSteps(int32_t cartesianPosSteps[], int32_t
    SHOWS(cartesianPosSteps[Y_AXIS]); \
    SHOW(Printer::deltaDiagonalStepsSquaredA.l);  return 0; }
    */
+/** Tower square roots of the last transformation, start values for the next one. */
+static uint16_t lastTowerRoot[TOWER_ARRAY] = {0, 0, 0};
+
+/**
+  Computes SQRT(v) for a tower height starting from the root of the last call.
+  Subsequent segments differ by only a few steps, so one newton step and a +-1
+  correction give the identical result with a single division instead of a full
+  square root. Large jumps fall back to SQRT.
+*/
+static uint16_t deltaTowerSqrt(uint32_t v, fast8_t tower) {
+    uint16_t r = lastTowerRoot[tower];
+    uint32_t r2 = static_cast<uint32_t>(r) * r;
+    uint32_t e = (v > r2 ? v - r2 : r2 - v);
+    if(r < 256 || e >= (static_cast<uint32_t>(r) << 6)) {
+        r = SQRT(v);
+    } else {
+        uint16_t d = HAL::Div4U2U(e, r) >> 1; // (v - r^2) / 2r
+        r = (v > r2 ? r + d : r - d);
+        r2 = static_cast<uint32_t>(r) * r;
+#if CPU_ARCH == ARCH_AVR // HAL::integerSqrt rounds to nearest
+        while(v > r2 + r) {
+            r2 += 2 * r + 1;
+            r++;
+        }
+        while(v <= r2 - r) {
+            r2 -= 2 * r - 1;
+            r--;
+        }
+#else // sqrt gets truncated
+        while(v > r2 + 2 * r) {
+            r2 += 2 * r + 1;
+            r++;
+        }
+        while(v < r2) {
+            r2 -= 2 * r - 1;
+            r--;
+        }
+#endif
+    }
+    lastTowerRoot[tower] = r;
+    return r;
+}
+
 /**
   Calculate the delta tower position from a Cartesian position
   @param cartesianPosSteps Array containing Cartesian coordinates.
@@ -1338,7 +1575,7 @@ uint8_t transformCartesianStepsToDeltaSteps(int32_t cartesianPosSteps[], int32_t
         if (opt < temp)
             RETURN_0("Apos x square ");
 
-        deltaPosSteps[A_TOWER] = SQRT(opt - temp) + zSteps;
+        deltaPosSteps[A_TOWER] = deltaTowerSqrt(opt - temp, A_TOWER) + zSteps;
         if (deltaPosSteps[A_TOWER] < Printer::deltaFloorSafetyMarginSteps && !Printer::isZProbingActive())
             RETURN_0("A hit floor");
 
@@ -1360,7 +1597,7 @@ uint8_t transformCartesianStepsToDeltaSteps(int32_t cartesianPosSteps[], int32_t
         if (opt < temp)
             RETURN_0("Bpos x square ");
 
-        deltaPosSteps[B_TOWER] = SQRT(opt - temp) + zSteps ;
+        deltaPosSteps[B_TOWER] = deltaTowerSqrt(opt - temp, B_TOWER) + zSteps ;
         if (deltaPosSteps[B_TOWER] < Printer::deltaFloorSafetyMarginSteps && !Printer::isZProbingActive())
             RETURN_0("B hit floor");
 
@@ -1382,7 +1619,7 @@ uint8_t transformCartesianStepsToDeltaSteps(int32_t cartesianPosSteps[], int32_t
         if ( opt < temp )
             RETURN_0("Cpos x square ");
 
-        deltaPosSteps[C_TOWER] = SQRT(opt - temp) + zSteps;
+        deltaPosSteps[C_TOWER] = deltaTowerSqrt(opt - temp, C_TOWER) + zSteps;
         if (deltaPosSteps[C_TOWER] < Printer::deltaFloorSafetyMarginSteps && !Printer::isZProbingActive())
             RETURN_0("C hit floor");
         /*
@@ -1862,6 +2099,41 @@ inline void PrintLine::queueEMove(int32_t extrudeDiff, uint8_t check_endstops, u
     p->calculateMove(axisDistanceMM, pathOptimize, E_AXIS);
 }
 
+#if DRIVE_SYSTEM == DELTA && DELTA_SEGMENT_TOLERANCE > 0
+/**
+  Number of segments needed to keep the linear tower interpolation within DELTA_SEGMENT_TOLERANCE.
+
+  A tower height h = sqrt(L^2 - d^2) has a curvature of at most L^2 / h^3 along a straight
+  line, so a segment of length l deviates at most l^2 L^2 / (8 h^3). d^2 is convex along the
+  line, so the lowest tower height of the move is at one of the end points.
+  @param distance Length of the move in mm.
+  @return Segment count or 0 if the move leaves the reachable area.
+*/
+static int16_t deltaSegmentsForTolerance(float distance) {
+    const int32_t towerX[3] = {Printer::deltaAPosXSteps, Printer::deltaBPosXSteps, Printer::deltaCPosXSteps};
+    const int32_t towerY[3] = {Printer::deltaAPosYSteps, Printer::deltaBPosYSteps, Printer::deltaCPosYSteps};
+    float maxD2 = 0;
+    for(fast8_t i = 0; i < 3; i++) {
+        float dx = static_cast<float>(towerX[i] - Printer::currentPositionSteps[X_AXIS]);
+        float dy = static_cast<float>(towerY[i] - Printer::currentPositionSteps[Y_AXIS]);
+        maxD2 = RMath::max(maxD2, dx * dx + dy * dy);
+        dx = static_cast<float>(towerX[i] - Printer::destinationSteps[X_AXIS]);
+        dy = static_cast<float>(towerY[i] - Printer::destinationSteps[Y_AXIS]);
+        maxD2 = RMath::max(maxD2, dx * dx + dy * dy);
+    }
+    float rodSteps = EEPROM::deltaDiagonalRodLength() * Printer::axisStepsPerMM[Z_AXIS];
+    float h2 = rodSteps * rodSteps - maxD2;
+    if(h2 <= 0)
+        return 0;
+    float distanceSteps = distance * Printer::axisStepsPerMM[Z_AXIS];
+    float toleranceSteps = DELTA_SEGMENT_TOLERANCE * 0.001f * Printer::axisStepsPerMM[Z_AXIS];
+    float count2 = distanceSteps * distanceSteps * rodSteps * rodSteps / (8.0f * toleranceSteps * h2 * sqrt(h2));
+    if(count2 > 32000.0f * 32000.0f)
+        return 32000;
+    return static_cast<int16_t>(ceil(sqrt(count2)));
+}
+#endif
+
 /**
   Split a line up into a series of lines with at most DELTASEGMENTS_PER_PRINTLINE delta segments.
   @param check_endstops Check endstops during the move.
@@ -1926,6 +2198,11 @@ uint8_t PrintLine::queueNonlinearMove(uint8_t check_endstops, uint8_t pathOptimi
 #endif
         float sps = static_cast<float>((cartesianDir & ESTEP) == ESTEP ? Printer::printMovesPerSecond : Printer::travelMovesPerSecond);
         segmentCount = RMath::max(1, static_cast<int16_t>(sps * seconds));
+#if DRIVE_SYSTEM == DELTA && DELTA_SEGMENT_TOLERANCE > 0
+        int16_t toleranceCount = deltaSegmentsForTolerance(cartesianDistance);
+        if(toleranceCount > 0 && toleranceCount < segmentCount)
+            segmentCount = toleranceCount;
+#endif
 #ifdef DEBUG_SEGMENT_LENGTH
         float segDist = cartesianDistance / (float)segmentCount;
         if(segDist > Printer::maxRealSegmentLength) {
@@ -1966,7 +2243,7 @@ uint8_t PrintLine::queueNonlinearMove(uint8_t check_endstops, uint8_t pathOptimi
 
     // Insert dummy moves if necessary
     // Need to leave at least one slot open for the first split move
-    insertWaitMovesIfNeeded(pathOptimize, RMath::min(PRINTLINE_CACHE_SIZE - 4, numLines));
+    insertWaitMovesIfNeeded(pathOptimize, RMath::min(static_cast<int>(PRINTLINE_QUEUE_LENGTH) - 4, numLines));
     uint32_t oldEDestination = Printer::destinationSteps[E_AXIS]; // flow and volumetric extrusion changed virtual target
     Printer::currentPositionSteps[E_AXIS] = 0;
 
@@ -2294,6 +2571,9 @@ int32_t PrintLine::bresenhamStep() { // Version for delta printer
         Printer::vMaxReached = cur->vStart;
         Printer::stepNumber = 0;
         Printer::timer = 0;
+#if STEP_RAMP_TABLE
+        Printer::rampIndex = 0;
+#endif
         HAL::forbidInterrupts();
 #if USE_ADVANCE
         if(!Printer::isAdvanceActivated()) // Set direction if no advance/OPS enabled
@@ -2467,6 +2747,12 @@ int32_t PrintLine::bresenhamStep() { // Version for delta printer
 #if RAMP_ACCELERATION
 //If acceleration is enabled on this move and we are in the acceleration segment, calculate the current interval
     if (cur->moveAccelerating()) {
+#if STEP_RAMP_TABLE
+        if(cur->isRampTable()) {
+            cur->updateAccelerationFromRamp();
+            Printer::stepNumber += maxLoops;
+        } else {
+#endif
         Printer::vMaxReached = HAL::ComputeV(Printer::timer, cur->fAcceleration) + cur->vStart;
         if(Printer::vMaxReached > cur->vMax) Printer::vMaxReached = cur->vMax;
         speed_t v = Printer::updateStepsPerTimerCall(Printer::vMaxReached);
@@ -2476,7 +2762,15 @@ int32_t PrintLine::bresenhamStep() { // Version for delta printer
         Printer::timer += Printer::interval;
         cur->updateAdvanceSteps(Printer::vMaxReached, maxLoops, true);
         Printer::stepNumber += maxLoops; // is only used by moveAccelerating
+#if STEP_RAMP_TABLE
+        }
+#endif
     } else if (cur->moveDecelerating()) { // time to slow down
+#if STEP_RAMP_TABLE
+        if(cur->isRampTable()) {
+            cur->updateDecelerationFromRamp();
+        } else {
+#endif
         speed_t v = HAL::ComputeV(Printer::timer, cur->fAcceleration);
         if (v > Printer::vMaxReached)   // if deceleration goes too far it can become too large
             v = cur->vEnd;
@@ -2490,11 +2784,22 @@ int32_t PrintLine::bresenhamStep() { // Version for delta printer
         // if(Printer::maxInterval < Printer::interval) // fix timing for very slow speeds
         //    Printer::interval = Printer::maxInterval;
         Printer::timer += Printer::interval;
+#if STEP_RAMP_TABLE
+        }
+#endif
     } else {
         // If we had acceleration, we need to use the latest vMaxReached and interval
         // If we started full speed, we need to use cur->fullInterval and vMax
-        cur->updateAdvanceSteps((!cur->accelSteps ? cur->vMax : Printer::vMaxReached), 0, true);
-        if(!cur->accelSteps) {
+        bool fullSpeed = !cur->accelSteps;
+#if STEP_RAMP_TABLE
+        // The ramp table ends with the interval of its last band, which is below vMax
+        if(cur->isRampTable()) {
+            Printer::vMaxReached = cur->vMax;
+            fullSpeed = true;
+        }
+#endif
+        cur->updateAdvanceSteps((fullSpeed ? cur->vMax : Printer::vMaxReached), 0, true);
+        if(fullSpeed) {
             if(cur->vMax > STEP_DOUBLER_FREQUENCY) {
 #if ALLOW_QUADSTEPPING
                 if(cur->vMax > STEP_DOUBLER_FREQUENCY * 2) {
@@ -2518,6 +2823,9 @@ int32_t PrintLine::bresenhamStep() { // Version for delta printer
     Printer::interval = cur->fullInterval; // without RAMPS always use full speed
 #endif
     PrintLine::cur->stepsRemaining -= maxLoops;
+#ifdef DEBUG_STEPPER_TIMING
+    Printer::timingIsrSteps += maxLoops;
+#endif
 
     if(cur->stepsRemaining <= 0 || cur->isNoMove()) { // line finished
         // Release remaining delta segments
@@ -2644,6 +2952,9 @@ int32_t PrintLine::bresenhamStep() { // version for Cartesian printer
         Printer::vMaxReached = cur->vStart;
         Printer::stepNumber = 0;
         Printer::timer = 0;
+#if STEP_RAMP_TABLE
+        Printer::rampIndex = 0;
+#endif
         HAL::forbidInterrupts();
         //Determine direction of movement,check if endstop was hit
 #if !(GANTRY)
@@ -2765,9 +3076,18 @@ int32_t PrintLine::bresenhamStep() { // version for Cartesian printer
         Printer::endXYZSteps();
     } // for loop
     HAL::allowInterrupts(); // Allow interrupts for other types, timer1 is still disabled
+#ifdef DEBUG_STEPPER_TIMING
+    Printer::timingIsrSteps += max_loops;
+#endif
 #if RAMP_ACCELERATION
     //If acceleration is enabled on this move and we are in the acceleration segment, calculate the current interval
     if (cur->moveAccelerating()) { // we are accelerating
+#if STEP_RAMP_TABLE
+        if(cur->isRampTable()) {
+            cur->updateAccelerationFromRamp();
+            Printer::stepNumber += max_loops;
+        } else {
+#endif
         Printer::vMaxReached = HAL::ComputeV(Printer::timer, cur->fAcceleration) + cur->vStart; // v = v0 + a * t
         if(Printer::vMaxReached > cur->vMax) Printer::vMaxReached = cur->vMax;
         unsigned int v = Printer::updateStepsPerTimerCall(Printer::vMaxReached);
@@ -2777,7 +3097,15 @@ int32_t PrintLine::bresenhamStep() { // version for Cartesian printer
         Printer::timer += Printer::interval;
         cur->updateAdvanceSteps(Printer::vMaxReached, max_loops, true);
         Printer::stepNumber += max_loops; // only used for moveAccelerating
+#if STEP_RAMP_TABLE
+        }
+#endif
     } else if (cur->moveDecelerating()) { // time to slow down
+#if STEP_RAMP_TABLE
+        if(cur->isRampTable()) {
+            cur->updateDecelerationFromRamp();
+        } else {
+#endif
         unsigned int v = HAL::ComputeV(Printer::timer, cur->fAcceleration);
         if (v > Printer::vMaxReached)   // if deceleration goes too far it can become too large
             v = cur->vEnd;
@@ -2791,6 +3119,9 @@ int32_t PrintLine::bresenhamStep() { // version for Cartesian printer
         // if(Printer::maxInterval < Printer::interval) // fix timing for very slow speeds
         //    Printer::interval = Printer::maxInterval;
         Printer::timer += Printer::interval;
+#if STEP_RAMP_TABLE
+        }
+#endif
     } else { // full speed reached
         cur->updateAdvanceSteps((!cur->accelSteps ? cur->vMax : Printer::vMaxReached), 0, true);
         // constant speed reached
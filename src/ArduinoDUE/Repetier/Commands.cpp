@@ -24,6 +24,109 @@ which based on Tonokip RepRap firmware rewrite based off of Hydra-mmm firmware.
 const int8_t sensitive_pins[] PROGMEM = SENSITIVE_PINS; // Sensitive pin list for M42
 int Commands::lowestRAMValue = MAX_RAM;
 int Commands::lowestRAMValueSend = MAX_RAM;
+millis_t Scheduler::nextRun[SCHEDULER_TASKS];
+#ifdef DEBUG_SCHEDULER_TIMING
+uint32_t Scheduler::runs[SCHEDULER_TASKS];
+uint32_t Scheduler::totalMicros[SCHEDULER_TASKS];
+uint32_t Scheduler::maxMicros[SCHEDULER_TASKS];
+uint32_t Scheduler::deferred[SCHEDULER_TASKS];
+#endif
+
+/** Planner has room for more moves and there are commands waiting to fill it. */
+bool Scheduler::plannerNeedsData() {
+    if(PrintLine::getLinesCount() >= PRINTLINE_QUEUE_LENGTH / 2)
+        return false;
+#if SDSUPPORT
+    if(sd.sdmode == 1)
+        return true;
+#endif
+    return GCode::bufferLength > 0;
+}
+
+bool Scheduler::isDue(uint8_t task, millis_t now, bool deferrable) {
+    int32_t late = static_cast<int32_t>(now - nextRun[task]);
+    if(late < 0)
+        return false;
+    if(deferrable && late < SCHEDULER_MAX_DEFER && plannerNeedsData()) {
+#ifdef DEBUG_SCHEDULER_TIMING
+        deferred[task]++;
+#endif
+        return false;
+    }
+    return true;
+}
+
+#ifdef DEBUG_SCHEDULER_TIMING
+void Scheduler::account(uint8_t task, uint32_t micros) {
+    runs[task]++;
+    totalMicros[task] += micros;
+    if(micros > maxMicros[task])
+        maxMicros[task] = micros;
+}
+
+void Scheduler::report() {
+    for(uint8_t i = 0; i < SCHEDULER_TASKS; i++) {
+        Com::printF(PSTR("Task "));
+        switch(i) {
+        case TASK_SERIAL:
+            Com::printF(PSTR("serial"));
+            break;
+        case TASK_PLANNER:
+            Com::printF(PSTR("planner"));
+            break;
+        case TASK_TEMPERATURE:
+            Com::printF(PSTR("temperature"));
+            break;
+        case TASK_MONITOR:
+            Com::printF(PSTR("monitor"));
+            break;
+        case TASK_UI:
+            Com::printF(PSTR("ui"));
+            break;
+        case TASK_SD_PREFETCH:
+            Com::printF(PSTR("sd prefetch"));
+            break;
+        case TASK_EEPROM:
+            Com::printF(PSTR("eeprom"));
+            break;
+        case TASK_OUTPUT:
+            Com::printF(PSTR("output"));
+            break;
+        }
+        Com::printF(PSTR(" runs:"), runs[i]);
+        if(runs[i])
+            Com::printF(PSTR(" avg us:"), static_cast<float>(totalMicros[i]) / static_cast<float>(runs[i]), 1);
+        Com::printF(PSTR(" max us:"), maxMicros[i]);
+        Com::printFLN(PSTR(" deferred:"), deferred[i]);
+    }
+}
+
+void Scheduler::reset() {
+    for(uint8_t i = 0; i < SCHEDULER_TASKS; i++) {
+        runs[i] = totalMicros[i] = maxMicros[i] = deferred[i] = 0;
+    }
+}
+#endif
+
+/** Writes the command to the open sd file or executes it and removes it from the buffer. */
+void Commands::executeNextCommand(GCode *code) {
+#if SDSUPPORT
+    if(sd.savetosd) {
+        if(!(code->hasM() && code->M == 29))   // still writing to file
+            sd.writeCommand(code);
+        else
+            sd.finishWrite();
+#if ECHO_ON_EXECUTE
+        code->echoCommand();
+#endif
+    } else
+#endif
+    {
+        SchedulerTaskTimer timer(TASK_PLANNER);
+        Commands::executeGCode(code);
+    }
+    code->popCurrentCommand();
+}
 
 void Commands::commandLoop() {
     //while(true) {
@@ -31,25 +134,17 @@ void Commands::commandLoop() {
     debugWaitLoop = 1;
 #endif
     if(!Printer::isBlockingReceive()) {
-        GCode::readFromSerial();
+        {
+            SchedulerTaskTimer timer(TASK_SERIAL);
+            GCode::readFromSerial();
+        }
         GCode *code = GCode::peekCurrentCommand();
-        //UI_SLOW; // do longer timed user interface action
         UI_MEDIUM; // do check encoder
-        if(code) {
 #if SDSUPPORT
-            if(sd.savetosd) {
-                if(!(code->hasM() && code->M == 29))   // still writing to file
-                    sd.writeCommand(code);
-                else
-                    sd.finishWrite();
-#if ECHO_ON_EXECUTE
-                code->echoCommand();
-#endif
-            } else
+        sd.countBufferUnderrun(code != NULL);
 #endif
-                Commands::executeGCode(code);
-            code->popCurrentCommand();
-        }
+        if(code)
+            executeNextCommand(code);
     } else {
         GCode::keepAlive(Paused);
         UI_MEDIUM;
@@ -70,21 +165,49 @@ void Commands::checkForPeriodicalActions(bool allowNewMoves) {
 #endif
     }
 #endif
-    if(!executePeriodical) return; // gets true every 100ms
-    executePeriodical = 0;
-    EVENT_TIMER_100MS;
-    Extruder::manageTemperatures();
-    if(--counter500ms == 0) {
+#if SDSUPPORT && SD_READ_AHEAD_BLOCKS
+    {
+        SchedulerTaskTimer timer(TASK_SD_PREFETCH);
+        sd.readAhead();
+    }
+#endif
+#if COM_OUTPUT_QUEUE
+    {
+        SchedulerTaskTimer timer(TASK_OUTPUT);
+        Com::flushOutput(false);
+    }
+#endif
+    if(executePeriodical) { // gets true every 100ms, also synchronizes the analog reads
+        executePeriodical = 0;
+        SchedulerTaskTimer timer(TASK_TEMPERATURE);
+        EVENT_TIMER_100MS;
+        Extruder::manageTemperatures();
+    }
+    millis_t now = HAL::timeInMilliseconds();
+    if(Scheduler::isDue(TASK_MONITOR, now, false)) {
+        Scheduler::schedule(TASK_MONITOR, now, 500);
+        SchedulerTaskTimer timer(TASK_MONITOR);
         if(manageMonitor)
             writeMonitor();
-        counter500ms = 5;
         EVENT_TIMER_500MS;
     }
-    // If called from queueDelta etc. it is an error to start a new move since it
-    // would invalidate old computation resulting in unpredicted behavior.
-    // lcd controller can start new moves, so we disallow it if called from within
-    // a move command.
-    UI_SLOW(allowNewMoves);
+    if(Scheduler::isDue(TASK_UI, now, true)) {
+        Scheduler::schedule(TASK_UI, now, 100);
+        SchedulerTaskTimer timer(TASK_UI);
+        // If called from queueDelta etc. it is an error to start a new move since it
+        // would invalidate old computation resulting in unpredicted behavior.
+        // lcd controller can start new moves, so we disallow it if called from within
+        // a move command.
+        UI_SLOW(allowNewMoves);
+    }
+#if defined(EEPROM_AVAILABLE) && EEPROM_AVAILABLE == EEPROM_SDCARD
+    // Only from the main loop, writing the card within a move command would delay it
+    if(allowNewMoves && Scheduler::isDue(TASK_EEPROM, now, true)) {
+        Scheduler::schedule(TASK_EEPROM, now, 1000);
+        SchedulerTaskTimer timer(TASK_EEPROM);
+        HAL::syncEEPROM();
+    }
+#endif
 }
 
 /** \brief Waits until movement cache is empty.
@@ -113,24 +236,10 @@ void Commands::waitUntilEndOfAllBuffers() {
     while(PrintLine::hasLines() || (code != NULL)) {
         //GCode::readFromSerial();
         code = GCode::peekCurrentCommand();
-        UI_MEDIUM; // do check encoder
-        if(code) {
-#if SDSUPPORT
-            if(sd.savetosd) {
-                if(!(code->hasM() && code->M == 29))   // still writing to file
-                    sd.writeCommand(code);
-                else
-                    sd.finishWrite();
-#if ECHO_ON_EXECUTE
-                code->echoCommand();
-#endif
-            } else
-#endif
-                Commands::executeGCode(code);
-            code->popCurrentCommand();
-        }
+        if(code)
+            executeNextCommand(code);
         Commands::checkForPeriodicalActions(false); // only called from memory
-        UI_MEDIUM;
+        UI_MEDIUM; // do check encoder
     }
 }
 
@@ -1059,7 +1168,7 @@ void Commands::processGCode(GCode *com) {
             int lp = (int)PrintLine::linesPos;
             int wp = (int)PrintLine::linesWritePos;
             int n = (wp - lp);
-            if(n < 0) n += PRINTLINE_CACHE_SIZE;
+            if(n < 0) n += PRINTLINE_QUEUE_LENGTH;
             noInts.unprotect();
             if(n != lc)
                 Com::printFLN(PSTR("Buffer corrupted"));
@@ -1693,6 +1802,11 @@ void Commands::processMCode(GCode *com) {
         sd.pausePrint();
         break;
     case 26: //M26 - Set SD index
+#if SD_BINARY_CONVERSION
+        if(com->hasL())
+            sd.setLayer(static_cast<uint16_t>(com->L));
+        else
+#endif
         if(com->hasS())
             sd.setIndex(com->S);
         break;
@@ -1719,6 +1833,12 @@ void Commands::processMCode(GCode *com) {
             sd.makeDirectory(com->text);
         }
         break;
+#if SD_BINARY_CONVERSION
+    case 35: // M35 filename - Convert file to binary file with layer index
+        if(com->hasString())
+            sd.convertToBinary(com->text);
+        break;
+#endif
 #endif
 #if JSON_OUTPUT && SDSUPPORT
     case 36: // M36 JSON File Info
@@ -2018,6 +2138,9 @@ void Commands::processMCode(GCode *com) {
 #endif
         Com::cap(PSTR("PAUSESTOP:1"));
         Com::cap(PSTR("PREHEAT:1"));
+#if NEW_COMMUNICATION
+        Com::cap(PSTR("BINARY_FRAMES:1"));
+#endif
         reportPrinterUsage();
         Printer::reportPrinterMode();
         break;
@@ -2400,6 +2523,12 @@ void Commands::processMCode(GCode *com) {
 #endif
     }
     break;
+#if NUM_EXTRUDER > 0
+    case 307: // M307 S<temp> F<filament mm/s> X0 Measure heater feed forward of active extruder
+        Extruder::current->tempControl.autotuneFeedForward(com->hasS() ? com->S : Extruder::current->tempControl.targetTemperatureC,
+                Extruder::current->id, com->hasF() ? com->F : 3.0f, com->hasX());
+        break;
+#endif
 
 #if FEATURE_AUTOLEVEL
     case 320: // M320 Activate autolevel
@@ -2583,7 +2712,7 @@ void Commands::processMCode(GCode *com) {
         int lp = (int)PrintLine::linesPos;
         int wp = (int)PrintLine::linesWritePos;
         int n = (wp - lp);
-        if(n < 0) n += PRINTLINE_CACHE_SIZE;
+        if(n < 0) n += PRINTLINE_QUEUE_LENGTH;
         noInts.unprotect();
         if(n != lc)
             Com::printFLN(PSTR("Buffer corrupted"));
@@ -2619,6 +2748,20 @@ void Commands::processMCode(GCode *com) {
         if(com->hasS())
             Printer::maxRealJerk = 0;
         break;
+#endif
+#ifdef DEBUG_STEPPER_TIMING
+    case 536: // M536 Report stepper and planner timing, S0 resets statistics
+        Printer::reportStepperTiming();
+        if(com->hasS())
+            Printer::resetStepperTiming();
+        break;
+#endif
+#ifdef DEBUG_SCHEDULER_TIMING
+    case 537: // M537 Report scheduler task timing, S0 resets statistics
+        Scheduler::report();
+        if(com->hasS())
+            Scheduler::reset();
+        break;
 #endif
     /*      case 535:  // M535
     Com::printF(PSTR("Last commanded position:"),Printer::lastCmdPos[X_AXIS]);
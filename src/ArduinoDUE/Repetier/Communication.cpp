@@ -401,6 +401,7 @@ FSTRINGVALUE(Com::tEPRDead, "Heater dead-time")
 FSTRINGVALUE(Com::tEPRUnused, "na for dead time ctrl")
 FSTRINGVALUE(Com::tEPRIGain, "PID I-gain")
 FSTRINGVALUE(Com::tEPRDGain, "PID D-gain")
+FSTRINGVALUE(Com::tEPRFeedForward, "Heater feed forward [PWM/(mm/s)]")
 FSTRINGVALUE(Com::tEPRPIDMaxValue, "PID max value [0-255]")
 FSTRINGVALUE(Com::tEPRXOffset, "X-offset [steps]")
 FSTRINGVALUE(Com::tEPRYOffset, "Y-offset [steps]")
@@ -471,6 +472,231 @@ FSTRINGVALUE(Com::tTrinamicMotorCurrent,  "Trinamic motor current:")
 FSTRINGVALUE(Com::tTrinamicMicrostepMode, "Trinamic microstep mode:")
 #endif
 bool Com::writeToAll = true; // transmit start messages to all devices!
+#if COM_OUTPUT_QUEUE
+/* Output records are a type byte followed by the arguments. Each line starts with a
+COM_LINE record holding its receivers, so it is sent to the same sources later. */
+#define COM_LINE 0
+#define COM_TEXT_F 1
+#define COM_TEXT 2
+#define COM_CHAR 3
+#define COM_INT32 4
+#define COM_UINT32 5
+#define COM_FLOAT 6
+#define COM_NEWLINE 7
+#define COM_FORMAT_ROOM 16 // free output bytes needed to format a number record
+struct ComLineRecord {
+    bool all;
+    GCodeSource *source;
+};
+uint8_t Com::outputQueue[COM_OUTPUT_QUEUE];
+uint16_t Com::outputHead = 0;
+uint16_t Com::outputTail = 0;
+uint16_t Com::outputLineEnd = 0;
+uint16_t Com::outputLineStart = 0;
+bool Com::outputInLine = false;
+bool Com::outputLowPriority = false;
+bool Com::outputDropping = false;
+bool Com::outputInText = false;
+bool Com::outputAll = true;
+GCodeSource *Com::outputSource = NULL;
+PGM_P Com::outputPendingText = NULL;
+bool Com::formatting = false;
+
+void Com::pushOutput(const void *data, uint8_t len) {
+    const uint8_t *p = reinterpret_cast<const uint8_t*>(data);
+    while(len--) {
+        outputQueue[outputHead] = *p++;
+        if(++outputHead == COM_OUTPUT_QUEUE) outputHead = 0;
+    }
+}
+
+void Com::popOutput(void *data, uint8_t len) {
+    uint8_t *p = reinterpret_cast<uint8_t*>(data);
+    while(len--) {
+        *p++ = outputQueue[outputTail];
+        if(++outputTail == COM_OUTPUT_QUEUE) outputTail = 0;
+    }
+}
+
+/** Formats one record directly. */
+void Com::writeRecord(uint8_t type, uint8_t *data) {
+    bool old = formatting;
+    formatting = true;
+    switch(type) {
+    case COM_TEXT_F: {
+        PGM_P text;
+        memcpy(&text, data, sizeof(text));
+        printF(text);
+    }
+    break;
+    case COM_TEXT:
+        print(reinterpret_cast<char*>(data));
+        break;
+    case COM_CHAR:
+        print(static_cast<char>(*data));
+        break;
+    case COM_INT32: {
+        int32_t v;
+        memcpy(&v, data, 4);
+        print(v);
+    }
+    break;
+    case COM_UINT32: {
+        uint32_t v;
+        memcpy(&v, data, 4);
+        printNumber(v);
+    }
+    break;
+    case COM_FLOAT: {
+        float v;
+        memcpy(&v, data, 4);
+        printFloat(v, data[4]);
+    }
+    break;
+    case COM_NEWLINE:
+        println();
+        break;
+    }
+    formatting = old;
+}
+
+/** Adds a record to the output queue. If it does not fit, an info or echo line is dropped
+completely, any other line is sent until the queue has room. */
+void Com::queueRecord(uint8_t type, const void *data, uint8_t len) {
+    if(!outputInLine) {
+        PGM_P text = NULL;
+        if(type == COM_TEXT_F)
+            memcpy(&text, data, sizeof(text));
+        outputLowPriority = text == tInfo || text == tEcho;
+        outputDropping = false;
+        outputInLine = true;
+        outputLineStart = outputHead;
+        ComLineRecord line;
+        line.all = writeToAll;
+        line.source = GCodeSource::activeSource;
+        queueRecord(COM_LINE, &line, sizeof(line));
+    }
+    if(outputDropping) {
+        if(type == COM_NEWLINE)
+            outputInLine = false;
+        return;
+    }
+    if(outputFree() < len + 1u) {
+        if(outputLowPriority) {
+            outputHead = outputLineStart;
+            outputDropping = true;
+            if(type == COM_NEWLINE)
+                outputInLine = false;
+            return;
+        }
+        flushOutput(true);
+        outputLineStart = outputHead;
+        if(outputFree() < len + 1u) { // larger than the queue, which is empty now
+            writeRecord(type, reinterpret_cast<uint8_t*>(const_cast<void*>(data)));
+            return;
+        }
+    }
+    pushOutput(&type, 1);
+    pushOutput(data, len);
+    if(type == COM_NEWLINE) {
+        outputInLine = false;
+        outputLineEnd = outputHead;
+        flushOutput(false);
+    }
+}
+
+/** Formats queued complete lines while the serial port has room. With all set everything
+is sent, waiting for the port if needed. */
+void Com::flushOutput(bool all) {
+    if(formatting) return;
+    formatting = true;
+    bool oldAll = writeToAll;
+    GCodeSource *oldSource = GCodeSource::activeSource;
+    writeToAll = outputAll;
+    GCodeSource::activeSource = outputSource;
+    while(true) {
+        if(outputPendingText) {
+            char c;
+            while((c = HAL::readFlashByte(outputPendingText)) != 0) {
+                if(!all && HAL::serialOutputSpace() <= 0) break;
+                GCodeSource::writeToAll(c);
+                outputPendingText++;
+            }
+            if(c) break;
+            outputPendingText = NULL;
+        }
+        if(outputTail == (all ? outputHead : outputLineEnd)) break;
+        if(outputInText) {
+            char c;
+            while((c = outputQueue[outputTail]) != 0) {
+                if(!all && HAL::serialOutputSpace() <= 0) break;
+                GCodeSource::writeToAll(c);
+                if(++outputTail == COM_OUTPUT_QUEUE) outputTail = 0;
+            }
+            if(c) break;
+            if(++outputTail == COM_OUTPUT_QUEUE) outputTail = 0;
+            outputInText = false;
+            continue;
+        }
+        if(!all && HAL::serialOutputSpace() < COM_FORMAT_ROOM) break;
+        uint8_t type, data[5];
+        popOutput(&type, 1);
+        switch(type) {
+        case COM_LINE: {
+            ComLineRecord line;
+            popOutput(&line, sizeof(line));
+            writeToAll = outputAll = line.all;
+            GCodeSource::activeSource = outputSource = line.source;
+        }
+        break;
+        case COM_TEXT_F:
+            popOutput(&outputPendingText, sizeof(outputPendingText));
+            break;
+        case COM_TEXT:
+            outputInText = true;
+            break;
+        case COM_CHAR:
+            popOutput(data, 1);
+            writeRecord(type, data);
+            break;
+        case COM_INT32:
+        case COM_UINT32:
+            popOutput(data, 4);
+            writeRecord(type, data);
+            break;
+        case COM_FLOAT:
+            popOutput(data, 5);
+            writeRecord(type, data);
+            break;
+        case COM_NEWLINE:
+            writeRecord(type, data);
+            break;
+        }
+    }
+    if(all)
+        outputLineEnd = outputHead;
+    writeToAll = oldAll;
+    GCodeSource::activeSource = oldSource;
+    formatting = false;
+}
+
+void Com::print(char c) {
+    if(!formatting) {
+        queueRecord(COM_CHAR, &c, 1);
+        return;
+    }
+    GCodeSource::writeToAll(c);
+}
+
+void Com::println() {
+    if(!formatting) {
+        queueRecord(COM_NEWLINE, NULL, 0);
+        return;
+    }
+    GCodeSource::writeToAll('\r');
+    GCodeSource::writeToAll('\n');
+}
+#endif
 
 void Com::cap(FSTRINGPARAM(text)) {
     printF(tCap);
@@ -538,6 +764,12 @@ void Com::printFLN(FSTRINGPARAM(text), const char *msg) {
 }
 
 void Com::printF(FSTRINGPARAM(ptr)) {
+#if COM_OUTPUT_QUEUE
+    if(!formatting) {
+        queueRecord(COM_TEXT_F, &ptr, sizeof(ptr));
+        return;
+    }
+#endif
     char c;
     while ((c = HAL::readFlashByte(ptr++)) != 0)
         GCodeSource::writeToAll(c);
@@ -585,11 +817,28 @@ void Com::printF(FSTRINGPARAM(text), float value, uint8_t digits) {
 }
 
 void Com::print(const char *text) {
+#if COM_OUTPUT_QUEUE
+    if(!formatting) {
+        size_t len = strlen(text) + 1;
+        if(len <= 255) {
+            queueRecord(COM_TEXT, text, len);
+            return;
+        }
+        flushOutput(true);
+    }
+#endif
     while(*text) {
         GCodeSource::writeToAll(*text++);
     }
 }
 void Com::print(long value) {
+#if COM_OUTPUT_QUEUE
+    if(!formatting) {
+        int32_t v = value;
+        queueRecord(COM_INT32, &v, 4);
+        return;
+    }
+#endif
     if(value < 0) {
         GCodeSource::writeToAll('-');
         value = -value;
@@ -598,6 +847,12 @@ void Com::print(long value) {
 }
 
 void Com::printNumber(uint32_t n) {
+#if COM_OUTPUT_QUEUE
+    if(!formatting) {
+        queueRecord(COM_UINT32, &n, 4);
+        return;
+    }
+#endif
     char buf[11]; // Assumes 8-bit chars plus zero byte.
     char *str = &buf[10];
     *str = '\0';
@@ -623,6 +878,15 @@ void Com::printArrayFLN(FSTRINGPARAM(text), int32_t *arr, uint8_t n) {
 }
 
 void Com::printFloat(float number, uint8_t digits) {
+#if COM_OUTPUT_QUEUE
+    if(!formatting) {
+        uint8_t data[5];
+        memcpy(data, &number, 4);
+        data[4] = digits;
+        queueRecord(COM_FLOAT, data, 5);
+        return;
+    }
+#endif
     if (isnan(number)) {
         printF(tNAN);
         return;
@@ -409,6 +409,7 @@ FSTRINGVAR(tEPRDead)
 FSTRINGVAR(tEPRUnused)
 FSTRINGVAR(tEPRIGain)
 FSTRINGVAR(tEPRDGain)
+FSTRINGVAR(tEPRFeedForward)
 FSTRINGVAR(tEPRPIDMaxValue)
 FSTRINGVAR(tEPRXOffset)
 FSTRINGVAR(tEPRYOffset)
@@ -514,10 +515,16 @@ static void print(long value);
 static inline void print(uint32_t value) {printNumber(value);}
 static inline void print(int value) {print((int32_t)value);}
 static void print(const char *text);
+#if COM_OUTPUT_QUEUE
+static void print(char c);
+static void println();
+static void flushOutput(bool all);
+#else
 static inline void print(char c) {GCodeSource::writeToAll(c);}
+static inline void println() {GCodeSource::writeToAll('\r');GCodeSource::writeToAll('\n');}
+#endif
 static void printFloat(float number, uint8_t digits);
 static inline void print(float number) {printFloat(number, 6);}
-static inline void println() {GCodeSource::writeToAll('\r');GCodeSource::writeToAll('\n');}
 static bool writeToAll;    
 #if FEATURE_CONTROLLER != NO_CONTROLLER
 static const char* translatedF(int textId);
@@ -526,6 +533,28 @@ static uint8_t selectedLanguage;
 #endif
     protected:
     private:
+#if COM_OUTPUT_QUEUE
+static void queueRecord(uint8_t type, const void *data, uint8_t len);
+static void writeRecord(uint8_t type, uint8_t *data);
+static void pushOutput(const void *data, uint8_t len);
+static void popOutput(void *data, uint8_t len);
+static inline uint16_t outputFree() {
+    return (outputTail + COM_OUTPUT_QUEUE - outputHead - 1) % COM_OUTPUT_QUEUE;
+}
+static uint8_t outputQueue[COM_OUTPUT_QUEUE];
+static uint16_t outputHead; ///< Next byte to write
+static uint16_t outputTail; ///< Next byte to format
+static uint16_t outputLineEnd; ///< End of the last complete line
+static uint16_t outputLineStart; ///< Start of the current line, to drop it
+static bool outputInLine;
+static bool outputLowPriority;
+static bool outputDropping;
+static bool outputInText; ///< Sending a ram text record
+static bool outputAll; ///< Receivers of the line being formatted
+static GCodeSource *outputSource;
+static PGM_P outputPendingText; ///< Rest of a flash text record
+static bool formatting;
+#endif
 };
 
 #ifdef DEBUG
@@ -1263,8 +1263,9 @@ Overridden if EEPROM activated.
 
 This number of moves can be cached in advance. If you want to cache more, increase this. Especially on
 many very short moves the cache may go empty. The minimum value is 5.
+The used length can be reduced in eeprom without recompiling, this value is the maximum.
 */
-#define PRINTLINE_CACHE_SIZE 32
+#define PRINTLINE_CACHE_SIZE 64
 
 /** \brief Low filled cache size.
 
@@ -1666,7 +1667,7 @@ motorized bed leveling */
 #define DISTORTION_XMAX 190
 #define DISTORTION_YMAX 190
 
-/** Uses EEPROM instead of ram. Allows bigger matrix (up to 22x22) without any ram cost.
+/** Uses EEPROM instead of ram. Allows bigger matrix (up to 22x22, 31x31 with DISTORTION_INT16) without any ram cost.
   Especially on arm based systems with cached EEPROM it is good, on AVR it has a small
   performance penalty.
 */
@@ -20,7 +20,7 @@
 #define _EEPROM_H
 
 // Id to distinguish version changes
-#define EEPROM_PROTOCOL_VERSION 19
+#define EEPROM_PROTOCOL_VERSION 21
 
 /** Where to start with our data block in memory. Can be moved if you
 have problems with other modules using the eeprom */
@@ -113,6 +113,7 @@ have problems with other modules using the eeprom */
 #define EPR_AXISCOMP_TANXZ			984
 
 #define EPR_DISTORTION_CORRECTION_ENABLED      988
+#define EPR_DISTORTION_LAYOUT                  991 // storage layout of the matrix at 2048
 #define EPR_RETRACTION_LENGTH                  992
 #define EPR_RETRACTION_LONG_LENGTH             996
 #define EPR_RETRACTION_SPEED                  1000
@@ -132,6 +133,7 @@ have problems with other modules using the eeprom */
 #define EPR_PARK_X						      1056
 #define EPR_PARK_Y                            1060
 #define EPR_PARK_Z                            1064
+#define EPR_PRINTLINE_CACHE_SIZE              1068
 
 
 
@@ -177,6 +179,7 @@ have problems with other modules using the eeprom */
 #define EPR_EXTRUDER_MIXING_RATIOS  58 // 16*2 byte ratios = 32 byte -> end = 89
 #define EPR_EXTRUDER_Z_OFFSET            90
 #define EPR_EXTRUDER_PREHEAT             94 // maybe better temperature
+#define EPR_EXTRUDER_FEED_FORWARD        96
 #ifndef Z_PROBE_BED_DISTANCE
 #define Z_PROBE_BED_DISTANCE 5.0
 #endif
@@ -526,7 +529,18 @@ static inline void setTowerZFloor(float newZ) {
 
     static void setZCorrection(int32_t c,int index);
     static inline int32_t getZCorrection(int index) {
+#if DISTORTION_INT16
+        return HAL::eprGetInt16(2048 + (index << 1));
+#else
         return HAL::eprGetInt32(2048 + (index << 2));
+#endif
+    }
+    static inline uint8_t getZCorrectionLayout() {
+        return HAL::eprGetByte(EPR_DISTORTION_LAYOUT);
+    }
+    static inline void setZCorrectionLayout(uint8_t layout) {
+        HAL::eprSetByte(EPR_DISTORTION_LAYOUT, layout);
+        EEPROM::updateChecksum();
     }
     static inline void setZCorrectionEnabled(int8_t on) {
 #if EEPROM_MODE != 0
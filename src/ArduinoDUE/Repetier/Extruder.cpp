@@ -24,7 +24,6 @@
 uint8_t manageMonitor = 0; ///< Temp. we want to monitor with our host. 1+NUM_EXTRUDER is heated bed
 unsigned int counterPeriodical = 0;
 volatile uint8_t executePeriodical = 0;
-uint8_t counter500ms = 5;
 #if FEATURE_DITTO_PRINTING
 uint8_t Extruder::dittoMode = 0;
 #endif
@@ -32,6 +31,10 @@ uint8_t Extruder::dittoMode = 0;
 int Extruder::mixingS;
 uint8_t Extruder::mixingDir = 10;
 uint8_t Extruder::activeMixingExtruder = 0;
+#if MIXING_PATTERN_LENGTH
+uint8_t Extruder::mixingPattern[MIXING_PATTERN_LENGTH];
+uint8_t Extruder::mixingPatternPos = 0;
+#endif
 #endif // MIXING_EXTRUDER
 #ifdef SUPPORT_MAX6675
 extern int16_t read_max6675(uint8_t ss_pin, fast8_t idx);
@@ -259,6 +262,8 @@ void Extruder::manageTemperatures() {
 #if SCALE_PID_TO_MAX == 1
                 pidTerm = (pidTerm * act->pidMax) * 0.0039215;
 #endif // SCALE_PID_TO_MAX
+                if(act->feedForward != 0 && act == &Extruder::current->tempControl) // heat for the queued extrusion before temperature drops
+                    pidTerm += act->feedForward * PrintLine::queuedExtrusionSpeed();
                 output = constrain((int)pidTerm, 0, act->pidMax);
             } else if(act->heatManager == HTR_DEADTIME) { // dead-time control
                 act->startHoldDecouple(time);
@@ -866,6 +871,47 @@ void Extruder::recomputeMixingExtruderSteps() {
     Printer::destinationSteps[E_AXIS] = Printer::currentPositionSteps[E_AXIS];
     Printer::axisStepsPerMM[E_AXIS] = sum;
     Printer::invAxisStepsPerMM[E_AXIS] = 1.0f / Printer::axisStepsPerMM[E_AXIS];
+#if MIXING_PATTERN_LENGTH
+    // Give each drive its share of the pattern steps, rounding by largest remainder, and
+    // spread them evenly with the same error diffusion the interrupt used before.
+    int16_t count[NUM_EXTRUDER], error[NUM_EXTRUDER];
+    int32_t remainder[NUM_EXTRUDER];
+    int16_t total = 0;
+    uint8_t pattern[MIXING_PATTERN_LENGTH];
+    fast8_t i;
+    for(i = 0; i < NUM_EXTRUDER; i++) {
+        int32_t share = mixingS > 0 ? static_cast<int32_t>(extruder[i].mixingWB) * MIXING_PATTERN_LENGTH : 0;
+        count[i] = mixingS > 0 ? share / mixingS : 0;
+        remainder[i] = mixingS > 0 && extruder[i].mixingWB > 0 ? share % mixingS : -1;
+        error[i] = 0;
+        total += count[i];
+    }
+    while(total < MIXING_PATTERN_LENGTH && mixingS > 0) {
+        fast8_t best = 0;
+        for(i = 1; i < NUM_EXTRUDER; i++)
+            if(remainder[i] > remainder[best])
+                best = i;
+        if(remainder[best] < 0) break;
+        count[best]++;
+        remainder[best] = -1;
+        total++;
+    }
+    for(uint8_t s = 0; s < MIXING_PATTERN_LENGTH; s++) {
+        uint8_t best = 255;
+        for(i = 0; i < NUM_EXTRUDER; i++) {
+            if(count[i] == 0) continue;
+            error[i] += count[i];
+            if(best == 255 || error[i] > error[best])
+                best = i;
+        }
+        if(best != 255)
+            error[best] -= MIXING_PATTERN_LENGTH;
+        pattern[s] = best;
+    }
+    InterruptProtectedBlock noInts;
+    memcpy(mixingPattern, pattern, MIXING_PATTERN_LENGTH);
+    mixingPatternPos = 0;
+#endif
 }
 #endif
 
@@ -1103,6 +1149,19 @@ void Extruder::step() {
 #endif
         return;
     }
+#if MIXING_PATTERN_LENGTH
+    // Retracting walks the pattern backwards, so it undoes the last steps of each drive
+    uint8_t best;
+    if(mixingDir) {
+        best = mixingPattern[mixingPatternPos];
+        if(++mixingPatternPos == MIXING_PATTERN_LENGTH)
+            mixingPatternPos = 0;
+    } else {
+        if(mixingPatternPos == 0)
+            mixingPatternPos = MIXING_PATTERN_LENGTH;
+        best = mixingPattern[--mixingPatternPos];
+    }
+#else
     uint8_t best = 255, i;
     int bestError;
     if(mixingDir) {
@@ -1130,6 +1189,7 @@ void Extruder::step() {
         if(best == 255) return; // no extruder has weight!
         extruder[best].mixingE += mixingS;
     }
+#endif
 #if NUM_EXTRUDER > 0
     if(best == 0) {
         WRITE(EXT0_STEP_PIN, START_STEP_WITH_HIGH);
@@ -2124,6 +2184,33 @@ const uint8_t temptables_num[16] PROGMEM = {NUMTEMPS_1, NUMTEMPS_2, NUMTEMPS_3,
                                            };
 
 
+/**
+  Converts a raw value with a table of raw/temperature pairs sorted by raw value.
+  A binary search finds the first entry with a larger raw value, so the costs grow only
+  with log2 of the table size. Interpolation uses integer math with 4 extra fraction bits.
+  Values outside the table get extrapolated from the first two entries or clamped to the last.
+*/
+static float temperatureFromTable(const short *temptable, uint8_t num, int raw, bool progmem) {
+#define TEMPTABLE_VALUE(i) (progmem ? static_cast<short>(pgm_read_word(&temptable[i])) : temptable[i])
+    uint8_t lo = 1, hi = num;
+    while(lo < hi) {
+        uint8_t mid = (lo + hi) >> 1;
+        if(TEMPTABLE_VALUE(mid << 1) > raw)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+    if(lo >= num) // Overflow: Set to last value in the table
+        return TEMP_INT_TO_FLOAT(TEMPTABLE_VALUE((num << 1) - 1));
+    int16_t oldraw = TEMPTABLE_VALUE((lo << 1) - 2);
+    int16_t oldtemp = TEMPTABLE_VALUE((lo << 1) - 1);
+    int16_t newraw = TEMPTABLE_VALUE(lo << 1);
+    int16_t newtemp = TEMPTABLE_VALUE((lo << 1) + 1);
+#undef TEMPTABLE_VALUE
+    int32_t temp = static_cast<int32_t>(oldtemp) * 16 + static_cast<int32_t>(raw - oldraw) * (static_cast<int32_t>(newtemp - oldtemp) * 16) / (newraw - oldraw);
+    return static_cast<float>(temp) * (1.0f / static_cast<float>(16 << CELSIUS_EXTRA_BITS));
+}
+
 void TemperatureController::updateCurrentTemperature() {
     uint8_t type = sensorType;
     // get raw temperature
@@ -2205,25 +2292,9 @@ void TemperatureController::updateCurrentTemperature() {
     case 15:
     case 16: {
         type--;
-        uint8_t num = pgm_read_byte(&temptables_num[type]) << 1;
-        uint8_t i = 2;
-        const int16_t *temptable = (const int16_t *)pgm_read_word(&temptables[type]); //pgm_read_word_near(&temptables[type]);
-        int16_t oldraw = pgm_read_word(&temptable[0]);
-        int16_t oldtemp = pgm_read_word(&temptable[1]);
-        int16_t newraw, newtemp = 0;
+        const short *temptable = (const short *)pgm_read_word(&temptables[type]); //pgm_read_word_near(&temptables[type]);
         currentTemperature = (1023 << (2 - ANALOG_REDUCE_BITS)) - currentTemperature;
-        while(i < num) {
-            newraw = pgm_read_word(&temptable[i++]);
-            newtemp = pgm_read_word(&temptable[i++]);
-            if (newraw > currentTemperature) {
-                currentTemperatureC = TEMP_INT_TO_FLOAT(oldtemp + (float)(currentTemperature - oldraw) * (float)(newtemp - oldtemp) / (newraw - oldraw));
-                return;
-            }
-            oldtemp = newtemp;
-            oldraw = newraw;
-        }
-        // Overflow: Set to last value in the table
-        currentTemperatureC = TEMP_INT_TO_FLOAT(newtemp);
+        currentTemperatureC = temperatureFromTable(temptable, pgm_read_byte(&temptables_num[type]), currentTemperature, true);
     }
     break;
     case 13:
@@ -2234,24 +2305,8 @@ void TemperatureController::updateCurrentTemperature() {
             type -= 46;
         else
             type--;
-        uint8_t num = pgm_read_byte(&temptables_num[type]) << 1;
-        uint8_t i = 2;
-        const int16_t *temptable = (const int16_t *)pgm_read_word(&temptables[type]); //pgm_read_word_near(&temptables[type]);
-        int16_t oldraw = pgm_read_word(&temptable[0]);
-        int16_t oldtemp = pgm_read_word(&temptable[1]);
-        int16_t newraw, newtemp = 0;
-        while(i < num) {
-            newraw = pgm_read_word(&temptable[i++]);
-            newtemp = pgm_read_word(&temptable[i++]);
-            if (newraw > currentTemperature) {
-                currentTemperatureC = TEMP_INT_TO_FLOAT(oldtemp + (float)(currentTemperature - oldraw) * (float)(newtemp - oldtemp) / (newraw - oldraw));
-                return;
-            }
-            oldtemp = newtemp;
-            oldraw = newraw;
-        }
-        // Overflow: Set to last value in the table
-        currentTemperatureC = TEMP_INT_TO_FLOAT(newtemp);
+        const short *temptable = (const short *)pgm_read_word(&temptables[type]); //pgm_read_word_near(&temptables[type]);
+        currentTemperatureC = temperatureFromTable(temptable, pgm_read_byte(&temptables_num[type]), currentTemperature, true);
         break;
     }
     case 60: // AD8495 (Delivers 5mV/degC vs the AD595's 10mV)
@@ -2301,7 +2356,6 @@ void TemperatureController::updateCurrentTemperature() {
     case 97:
     case 98:
     case 99: {
-        uint8_t i = 2;
         const short *temptable;
 #ifdef USE_GENERIC_THERMISTORTABLE_1
         if(type == 97)
@@ -2315,22 +2369,8 @@ void TemperatureController::updateCurrentTemperature() {
         if(type == 99)
             temptable = (const short *)temptable_generic3;
 #endif
-        short oldraw = temptable[0];
-        short oldtemp = temptable[1];
-        short newraw, newtemp;
         currentTemperature = (1023 << (2 - ANALOG_REDUCE_BITS)) - currentTemperature;
-        while(i < GENERIC_THERM_NUM_ENTRIES * 2) {
-            newraw = temptable[i++];
-            newtemp = temptable[i++];
-            if (newraw > currentTemperature) {
-                currentTemperatureC = TEMP_INT_TO_FLOAT(oldtemp + (float)(currentTemperature - oldraw) * (float)(newtemp - oldtemp) / (newraw - oldraw));
-                return;
-            }
-            oldtemp = newtemp;
-            oldraw = newraw;
-        }
-        // Overflow: Set to last value in the table
-        currentTemperatureC = TEMP_INT_TO_FLOAT(newtemp);
+        currentTemperatureC = temperatureFromTable(temptable, GENERIC_THERM_NUM_ENTRIES, currentTemperature, false);
         break;
     }
 #endif
@@ -2502,6 +2542,94 @@ void TemperatureController::autotunePID(float temp, uint8_t controllerId, int ma
     } // loop
 }
 
+/** \brief Measures the heater feed forward of the active extruder.
+
+Holds temp with PID control and averages the heater output, first without extrusion and then while
+extruding with speed mm/s. The additional output divided by speed is the heater power needed per
+mm/s filament, which manageTemperatures adds for the queued moves. Each phase settles 30 seconds
+and averages 30 seconds, so 60 * speed mm filament are extruded.
+*/
+void TemperatureController::autotuneFeedForward(float temp, uint8_t controllerId, float speed, bool storeValues) {
+    ENSURE_POWER
+    if(controllerId >= NUM_EXTRUDER || this != &Extruder::current->tempControl || heatManager != HTR_PID || speed <= 0) {
+        Com::printErrorFLN(PSTR("Feed forward needs the active extruder with PID control and F > 0"));
+        return;
+    }
+    float oldTarget = targetTemperatureC;
+    float oldFeedForward = feedForward;
+    feedForward = 0; // measure pure PID output
+    Extruder::setTemperatureForExtruder(temp, controllerId, false, false);
+    Com::printInfoFLN(PSTR("Feed forward autotune start"));
+    millis_t startTime = HAL::timeInMilliseconds();
+    millis_t phaseTime = startTime;
+    millis_t sampleTime = startTime;
+    millis_t printTime = startTime;
+    uint8_t phase = 0; // 0 = heat up, 1 = settle, 2 = average, 3 = settle extruding, 4 = average extruding
+    float idleOutput = 0, extrudeOutput = 0, sum = 0;
+    int samples = 0;
+    int32_t eSteps = static_cast<int32_t>(speed * Extruder::current->stepsPerMM);
+    for(;;) {
+#if FEATURE_WATCHDOG
+        HAL::pingWatchdog();
+#endif // FEATURE_WATCHDOG
+        Commands::checkForPeriodicalActions(true); // update heaters etc.
+        GCode::keepAlive(WaitHeater);
+        millis_t time = HAL::timeInMilliseconds();
+        if(phase >= 3 && PrintLine::getLinesCount() < 2) // keep 1s moves queued
+            PrintLine::moveRelativeDistanceInSteps(0, 0, 0, eSteps, speed, false, false);
+        if(phase == 0 && fabs(currentTemperatureC - temp) < 1) {
+            phase = 1;
+            phaseTime = time;
+        } else if(phase > 0 && time - phaseTime > 30000) {
+            if((phase == 2 || phase == 4) && samples == 0) {
+                Com::printErrorFLN(PSTR("Feed forward autotune failed! no samples"));
+                feedForward = oldFeedForward;
+                break;
+            }
+            if(phase == 2)
+                idleOutput = sum / samples;
+            else if(phase == 4)
+                extrudeOutput = sum / samples;
+            phase++;
+            phaseTime = time;
+            sum = 0;
+            samples = 0;
+        }
+        if((phase == 2 || phase == 4) && time - sampleTime >= 100) {
+            sum += pwm_pos[pwmIndex];
+            samples++;
+            sampleTime = time;
+        }
+        if(phase == 5) {
+            float ff = (extrudeOutput - idleOutput) / speed;
+            Com::printFLN(PSTR(" Idle output:"), idleOutput);
+            Com::printFLN(PSTR(" Feed forward [PWM/(mm/s)]:"), ff, 3);
+            feedForward = storeValues ? RMath::max(0.0f, ff) : oldFeedForward;
+            if(storeValues)
+                EEPROM::storeDataIntoEEPROM();
+            break;
+        }
+        if(currentTemperatureC > temp + 40) {
+            Com::printErrorFLN(Com::tAPIDFailedHigh);
+            feedForward = oldFeedForward;
+            break;
+        }
+        if(time - startTime > 10L * 60L * 1000L) { // 10 Minutes
+            Com::printErrorFLN(PSTR("Feed forward autotune failed! timeout"));
+            feedForward = oldFeedForward;
+            break;
+        }
+        if(time - printTime > 1000) {
+            printTime = time;
+            Commands::printTemperatures();
+        }
+        UI_MEDIUM;
+        UI_SLOW(true);
+    }
+    Commands::waitUntilEndOfAllMoves();
+    Extruder::setTemperatureForExtruder(oldTarget, controllerId, false, false);
+}
+
 /** \brief Writes monitored temperatures.
 
 This function is called every 250ms to write the monitored temperature. If monitoring is
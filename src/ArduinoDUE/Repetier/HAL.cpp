@@ -40,6 +40,11 @@ int32_t osAnalogSamplesSum[ANALOG_INPUTS];
 static int32_t adcSamplesMin[ANALOG_INPUTS];
 static int32_t adcSamplesMax[ANALOG_INPUTS];
 static int adcCounter = 0, adcSamplePos = 0;
+#if DUE_ADC_PDC
+#define ADC_PDC_SAMPLES (ANALOG_INPUTS * (NUM_ADC_SAMPLES))
+static uint16_t adcPdcBuffer[ADC_PDC_SAMPLES]; ///< Tagged conversion results written by PDC
+static int8_t adcChannelInput[16]; ///< Analog input index for each ADC channel, -1 if unused
+#endif
 #endif
 
 static   uint32_t  adcEnable = 0;
@@ -357,10 +362,59 @@ void HAL::analogStart(void) {
     ADC->ADC_CGR = 0;             // Gain = 1
     ADC->ADC_COR = 0;             // Single-ended, no offset
 
+#if DUE_ADC_PDC
+    // free running conversions, tagged with channel number so PDC data can be assigned after restarts
+    for (int i = 0; i < 16; i++)
+        adcChannelInput[i] = -1;
+    for (int i = 0; i < ANALOG_INPUTS; i++)
+        adcChannelInput[osAnalogInputChannels[i]] = i;
+    ADC->ADC_MR |= ADC_MR_FREERUN_ON;
+    ADC->ADC_EMR = ADC_EMR_TAG;
+    ADC->ADC_RPR = (uint32_t)adcPdcBuffer;
+    ADC->ADC_RCR = ADC_PDC_SAMPLES;
+    ADC->ADC_RNCR = 0;
+    ADC->ADC_PTCR = ADC_PTCR_RXTEN;
+#endif
     // start first conversion
     ADC->ADC_CR = ADC_CR_START;
 }
 
+#if DUE_ADC_PDC
+/** Filters a complete PDC block. Like the interrupt driven sampling, the biggest and smallest
+value of each input are stripped and the mean is fed into the ANALOG_INPUT_MEDIAN average. */
+static void analogProcessPdcBlock() {
+    int32_t sum[ANALOG_INPUTS], count[ANALOG_INPUTS];
+    for (int i = 0; i < ANALOG_INPUTS; i++) {
+        sum[i] = count[i] = 0;
+        adcSamplesMin[i] = 100000;
+        adcSamplesMax[i] = 0;
+    }
+    for (int j = 0; j < ADC_PDC_SAMPLES; j++) {
+        uint16_t v = adcPdcBuffer[j];
+        int8_t i = adcChannelInput[v >> 12];
+        if (i < 0) continue;
+        int32_t cur = v & 4095;
+        sum[i] += cur;
+        count[i]++;
+        adcSamplesMin[i] = RMath::min(adcSamplesMin[i], cur);
+        adcSamplesMax[i] = RMath::max(adcSamplesMax[i], cur);
+    }
+    for (int i = 0; i < ANALOG_INPUTS; i++) {
+        if (count[i] < 3) continue; // no usable values for this input in block
+        int32_t n = count[i] - 2;
+        int32_t value = (sum[i] - adcSamplesMin[i] - adcSamplesMax[i] + (n >> 1)) / n;
+        osAnalogSamplesSum[i] -= osAnalogSamples[i][adcSamplePos];
+        osAnalogSamplesSum[i] += (osAnalogSamples[i][adcSamplePos] = value);
+        if(executePeriodical == 0 || i >= NUM_ANALOG_TEMP_SENSORS) {
+            osAnalogInputValues[i] = osAnalogSamplesSum[i] / ANALOG_INPUT_MEDIAN;
+        }
+    }
+    adcSamplePos++;
+    if (adcSamplePos >= ANALOG_INPUT_MEDIAN)
+        adcSamplePos = 0;
+}
+#endif
+
 #endif
 
 #if EEPROM_AVAILABLE == EEPROM_SDCARD
@@ -371,6 +425,104 @@ void HAL::analogStart(void) {
 
 millis_t eprSyncTime = 0; // in sync
 SdFile eepromFile;
+/* The journal eeprom.jnl holds 8 byte records of changed 4 byte words, appended in
+batches of up to one sd block. eeprom.bin is only rewritten when the journal is full,
+so small changes like babysteps or usage counters cost one block write. Without
+EEPROM_SD_JOURNAL_SIZE a journal left from earlier is still replayed once and then
+removed after the next full write, so it can never be replayed over a newer eeprom.bin. */
+#define EEPROM_JOURNAL_RECORDS (512 / sizeof(EEPROMJournalRecord))
+struct EEPROMJournalRecord {
+    uint16_t pos;
+    uint16_t check;
+    uint32_t value;
+    inline uint16_t checksum() const {
+        return pos ^ static_cast<uint16_t>(value) ^ static_cast<uint16_t>(value >> 16) ^ 0x5AA5;
+    }
+};
+SdFile eepromJournal;
+static EEPROMJournalRecord eepromJournalBuffer[EEPROM_JOURNAL_RECORDS];
+#if EEPROM_SD_JOURNAL_SIZE
+uint8_t eprDirty[EEPROM_BYTES / 32];
+
+/** Appends all dirty words to the journal. Returns false if the journal has no room or a write failed. */
+bool HAL::writeEEPROMJournal() {
+    uint16_t dirtyWords = 0;
+    for(uint16_t i = 0; i < EEPROM_BYTES / 32; i++)
+        for(uint8_t b = eprDirty[i]; b; b &= b - 1)
+            dirtyWords++;
+    // Rewriting eeprom.bin is cheaper if most of the eeprom changed
+    if(dirtyWords * sizeof(EEPROMJournalRecord) >= EEPROM_BYTES || !eepromJournal.isOpen()
+            || eepromJournal.fileSize() + dirtyWords * sizeof(EEPROMJournalRecord) > EEPROM_SD_JOURNAL_SIZE)
+        return false;
+    if(!eepromJournal.seekEnd())
+        return false;
+    uint16_t n = 0;
+    for(uint16_t w = 0; w < EEPROM_BYTES / 4; w++) {
+        if(!(eprDirty[w >> 3] & (1 << (w & 7))))
+            continue;
+        EEPROMJournalRecord &r = eepromJournalBuffer[n++];
+        r.pos = w << 2;
+        memcopy4(&r.value, &virtualEeprom[r.pos]);
+        r.check = r.checksum();
+        if(n == EEPROM_JOURNAL_RECORDS) {
+            if(eepromJournal.write(eepromJournalBuffer, sizeof(eepromJournalBuffer)) != static_cast<int>(sizeof(eepromJournalBuffer)))
+                return false;
+            n = 0;
+        }
+    }
+    if(n && eepromJournal.write(eepromJournalBuffer, n * sizeof(EEPROMJournalRecord)) != static_cast<int>(n * sizeof(EEPROMJournalRecord)))
+        return false;
+    if(!eepromJournal.sync())
+        return false;
+    memset(eprDirty, 0, sizeof(eprDirty));
+    return true;
+}
+
+/** Writes the complete eeprom to eeprom.bin and empties the journal. */
+bool HAL::compactEEPROM() {
+    if(!eepromFile.seekSet(0) || eepromFile.write(virtualEeprom, EEPROM_BYTES) != EEPROM_BYTES)
+        return false;
+    memset(eprDirty, 0, sizeof(eprDirty));
+    if(eepromJournal.isOpen())
+        eepromJournal.truncate(0);
+    else
+        eepromJournal.open("eeprom.jnl", O_RDWR | O_CREAT | O_TRUNC);
+    return eepromJournal.isOpen() && eepromJournal.sync();
+}
+#endif
+
+/** Applies all valid journal records to the eeprom read from eeprom.bin. A torn last
+record from a power loss ends the replay and is cut off. Returns true if a journal is open. */
+bool HAL::replayEEPROMJournal() {
+    if(eepromJournal.isOpen())
+        eepromJournal.close();
+#if EEPROM_SD_JOURNAL_SIZE
+    if(!eepromJournal.open("eeprom.jnl", O_RDWR | O_CREAT))
+#else
+    if(!eepromJournal.open("eeprom.jnl", O_RDWR))
+#endif
+        return false;
+    uint32_t validBytes = 0;
+    int n;
+    while((n = eepromJournal.read(eepromJournalBuffer, sizeof(eepromJournalBuffer))) > 0) {
+        uint16_t records = n / sizeof(EEPROMJournalRecord);
+        for(uint16_t i = 0; i < records; i++) {
+            EEPROMJournalRecord &r = eepromJournalBuffer[i];
+            if(r.check != r.checksum() || r.pos >= EEPROM_BYTES || (r.pos & 3)) {
+                eepromJournal.truncate(validBytes);
+                return true;
+            }
+            memcopy4(&virtualEeprom[r.pos], &r.value);
+            validBytes += sizeof(EEPROMJournalRecord);
+        }
+        if(n != static_cast<int>(sizeof(eepromJournalBuffer)))
+            break;
+    }
+    if(validBytes != eepromJournal.fileSize())
+        eepromJournal.truncate(validBytes);
+    return true;
+}
+
 void HAL::syncEEPROM() { // store to disk if changed
     millis_t time = millis();
 
@@ -380,17 +532,27 @@ void HAL::syncEEPROM() { // store to disk if changed
         if (!sd.sdactive) { // not mounted
             if (eepromFile.isOpen())
                 eepromFile.close();
+            if (eepromJournal.isOpen())
+                eepromJournal.close();
             Com::printErrorF("Could not write eeprom to sd card - no sd card mounted");
             Com::println();
             return;
         }
 
+#if EEPROM_SD_JOURNAL_SIZE
+        if(!writeEEPROMJournal())
+            failed = !compactEEPROM();
+#else
         if (!eepromFile.seekSet(0))
             failed = true;
 
-        if(!failed && !eepromFile.write(virtualEeprom, EEPROM_BYTES) == EEPROM_BYTES)
+        if(!failed && eepromFile.write(virtualEeprom, EEPROM_BYTES) != EEPROM_BYTES)
             failed = true;
 
+        if(!failed && eepromJournal.isOpen()) // contents are in eeprom.bin now
+            eepromJournal.remove();
+#endif
+
         if(failed) {
             Com::printErrorF("Could not write eeprom to sd card");
             Com::println();
@@ -407,6 +569,13 @@ void HAL::importEEPROM() {
     } else {
         Com::printFLN("EEPROM read from sd card.");
     }
+#if EEPROM_SD_JOURNAL_SIZE
+    replayEEPROMJournal();
+    memset(eprDirty, 0, sizeof(eprDirty));
+#else
+    if(replayEEPROMJournal())
+        eprSyncTime = HAL::timeInMilliseconds() | 1UL; // write it to eeprom.bin, then remove the journal
+#endif
     EEPROM::readDataFromEEPROM(true);
 }
 
@@ -972,6 +1141,9 @@ void TIMER1_COMPA_VECTOR () {
     uint32_t delay;
     if (PrintLine::hasLines()) {
         delay = PrintLine::bresenhamStep();
+#ifdef DEBUG_STEPPER_TIMING
+        Printer::updateStepperTiming(stepperChannel->TC_CV / TIMER1_PRESCALE); // in F_CPU ticks
+#endif
     }
 #if FEATURE_BABYSTEPPING
     else if (Printer::zBabystepsMissing != 0) {
@@ -1076,6 +1248,9 @@ void PWM_TIMER_VECTOR () {
     //InterruptProtectedBlock noInt;
     // apparently have to read status register
     TC_GetStatus(PWM_TIMER, PWM_TIMER_CHANNEL);
+#if SERIAL_PDC
+    PDCSerial.service();
+#endif
 
     static uint8_t pwm_count_cooler = 0;
     static uint8_t pwm_count_heater = 0;
@@ -1295,7 +1470,13 @@ void PWM_TIMER_VECTOR () {
 #endif
     }
     // read analog values -- only read one per interrupt
-#if ANALOG_INPUTS > 0
+#if ANALOG_INPUTS > 0 && DUE_ADC_PDC
+    if (ADC->ADC_RCR == 0) { // PDC block complete
+        analogProcessPdcBlock();
+        ADC->ADC_RPR = (uint32_t)adcPdcBuffer;
+        ADC->ADC_RCR = ADC_PDC_SAMPLES;
+    }
+#elif ANALOG_INPUTS > 0
     // conversion finished?
     if ((ADC->ADC_ISR & adcEnable) == adcEnable) {
         adcCounter++;
@@ -1407,6 +1588,104 @@ void BEEPER_TIMER_VECTOR () {
     toggle = !toggle;
 }
 
+#if SERIAL_PDC
+/* Receiving uses the buffer as two halves. The pdc fills one while the other is queued as
+next buffer, service() queues the finished half again as soon as the pdc switched. Sending
+transfers the continuous block from txTail up to txHead or the buffer end in one go. */
+void RFPdcSerial::begin(unsigned long baud) {
+    pmc_enable_periph_clk(ID_UART);
+    NVIC_DisableIRQ(UART_IRQn);
+    UART->UART_PTCR = UART_PTCR_RXTDIS | UART_PTCR_TXTDIS;
+    UART->UART_CR = UART_CR_RSTRX | UART_CR_RSTTX | UART_CR_RXDIS | UART_CR_TXDIS;
+    UART->UART_MR = UART_MR_PAR_NO | UART_MR_CHMODE_NORMAL;
+    UART->UART_BRGR = (SystemCoreClock / baud) >> 4;
+    UART->UART_IDR = 0xFFFFFFFF;
+    rxTail = txHead = txTail = txSending = 0;
+    UART->UART_RPR = reinterpret_cast<uint32_t>(rxBuffer);
+    UART->UART_RCR = SERIAL_RX_BUFFER_LENGTH / 2;
+    UART->UART_RNPR = reinterpret_cast<uint32_t>(&rxBuffer[SERIAL_RX_BUFFER_LENGTH / 2]);
+    UART->UART_RNCR = SERIAL_RX_BUFFER_LENGTH / 2;
+    UART->UART_TCR = 0;
+    UART->UART_TNCR = 0;
+    UART->UART_PTCR = UART_PTCR_RXTEN | UART_PTCR_TXTEN;
+    UART->UART_CR = UART_CR_RXEN | UART_CR_TXEN;
+}
+
+void RFPdcSerial::end() {
+    flush();
+    UART->UART_PTCR = UART_PTCR_RXTDIS | UART_PTCR_TXTDIS;
+    UART->UART_CR = UART_CR_RXDIS | UART_CR_TXDIS;
+    pmc_disable_periph_clk(ID_UART);
+}
+
+inline uint32_t RFPdcSerial::rxHead() {
+    return (UART->UART_RPR - reinterpret_cast<uint32_t>(rxBuffer)) & (SERIAL_RX_BUFFER_LENGTH - 1);
+}
+
+int RFPdcSerial::available(void) {
+    return (rxHead() - rxTail) & (SERIAL_RX_BUFFER_LENGTH - 1);
+}
+
+int RFPdcSerial::peek(void) {
+    if(rxHead() == rxTail)
+        return -1;
+    return rxBuffer[rxTail];
+}
+
+int RFPdcSerial::read(void) {
+    if(rxHead() == rxTail)
+        return -1;
+    uint8_t c = rxBuffer[rxTail];
+    rxTail = (rxTail + 1) & (SERIAL_RX_BUFFER_LENGTH - 1);
+    return c;
+}
+
+void RFPdcSerial::flush(void) {
+    while(txHead != txTail || UART->UART_TCR != 0 || !(UART->UART_SR & UART_SR_TXEMPTY))
+        service();
+}
+
+int RFPdcSerial::availableForWrite(void) {
+    return (txTail - txHead - 1) & (SERIAL_TX_BUFFER_LENGTH - 1);
+}
+
+size_t RFPdcSerial::write(uint8_t c) {
+    uint32_t next = (txHead + 1) & (SERIAL_TX_BUFFER_LENGTH - 1);
+    while(next == txTail) // buffer full, wait for the running block
+        service();
+    txBuffer[txHead] = c;
+    txHead = next;
+    if(UART->UART_TCR == 0)
+        service();
+    return 1;
+}
+
+void RFPdcSerial::startTx() {
+    uint32_t head = txHead;
+    if(head == txTail)
+        return;
+    txSending = (head > txTail ? head : SERIAL_TX_BUFFER_LENGTH) - txTail;
+    UART->UART_TPR = reinterpret_cast<uint32_t>(&txBuffer[txTail]);
+    UART->UART_TCR = txSending;
+}
+
+void RFPdcSerial::service() {
+    InterruptProtectedBlock noInts;
+    if(UART->UART_RNCR == 0) { // pdc switched to the queued half, queue the finished one
+        uint32_t next = UART->UART_RPR - reinterpret_cast<uint32_t>(rxBuffer) < SERIAL_RX_BUFFER_LENGTH / 2 ?
+                        SERIAL_RX_BUFFER_LENGTH / 2 : 0;
+        UART->UART_RNPR = reinterpret_cast<uint32_t>(&rxBuffer[next]);
+        UART->UART_RNCR = SERIAL_RX_BUFFER_LENGTH / 2;
+    }
+    if(UART->UART_TCR == 0) {
+        txTail = (txTail + txSending) & (SERIAL_TX_BUFFER_LENGTH - 1);
+        txSending = 0;
+        startTx();
+    }
+}
+RFPdcSerial PDCSerial;
+#endif
+
 #if defined(BLUETOOTH_SERIAL) && BLUETOOTH_SERIAL > 0
 RFDoubleSerial::RFDoubleSerial() {
 }
@@ -240,6 +240,12 @@ class InterruptProtectedBlock {
 #define SECONDS_TO_TICKS(s) (unsigned long)(s*(float)F_CPU)
 #define ANALOG_INPUT_SAMPLE 6
 #define ANALOG_INPUT_MEDIAN 10
+/** Let the ADC run free and collect the conversions with the peripheral DMA controller.
+The interrupt only filters a complete block of samples instead of reading the converter
+registers every time, and temperatures get sampled about twice as often. */
+#ifndef DUE_ADC_PDC
+#define DUE_ADC_PDC 0
+#endif
 
 // Bits of the ADC converter
 #define ANALOG_INPUT_BITS 12
@@ -274,6 +280,51 @@ typedef unsigned int flag8_t;
 typedef int fast8_t;
 typedef unsigned int ufast8_t;
 
+/** Drive the programming port with the peripheral DMA controller (PDC) instead of one
+interrupt per character. The pwm timer interrupt rearms the transfers, so high baud rates
+and verbose output do not stall the main loop. Buffer lengths must be a power of 2. */
+#ifndef SERIAL_PDC
+#define SERIAL_PDC 0
+#endif
+#ifndef SERIAL_RX_BUFFER_LENGTH
+#define SERIAL_RX_BUFFER_LENGTH 1024
+#endif
+#ifndef SERIAL_TX_BUFFER_LENGTH
+#define SERIAL_TX_BUFFER_LENGTH 1024
+#endif
+#if SERIAL_PDC
+#if (SERIAL_RX_BUFFER_LENGTH & (SERIAL_RX_BUFFER_LENGTH - 1)) || (SERIAL_TX_BUFFER_LENGTH & (SERIAL_TX_BUFFER_LENGTH - 1))
+#error SERIAL_RX_BUFFER_LENGTH and SERIAL_TX_BUFFER_LENGTH must be a power of 2
+#endif
+class RFPdcSerial : public Print
+{
+  public:
+    void begin(unsigned long);
+    void end();
+    virtual int available(void);
+    virtual int peek(void);
+    virtual int read(void);
+    virtual void flush(void);
+    virtual size_t write(uint8_t);
+    using Print::write; // pull in write(str) and write(buf, size) from Print
+    int availableForWrite(void);
+    void service(); // rearm receive buffer and start next send block, called from pwm interrupt
+  private:
+    inline uint32_t rxHead();
+    void startTx();
+    uint8_t rxBuffer[SERIAL_RX_BUFFER_LENGTH];
+    uint8_t txBuffer[SERIAL_TX_BUFFER_LENGTH];
+    uint32_t rxTail;
+    volatile uint32_t txHead;
+    volatile uint32_t txTail;
+    volatile uint32_t txSending; // bytes in the running pdc transfer
+};
+extern RFPdcSerial PDCSerial;
+#ifndef RFSERIAL
+#define RFSERIAL PDCSerial
+#endif
+#endif
+
 #ifndef RFSERIAL
 #define RFSERIAL Serial   // Programming port of the due
 //#define RFSERIAL SerialUSB  // Native USB Port of the due
@@ -319,7 +370,15 @@ union eeval_t {
 } PACK;
 
 #if EEPROM_AVAILABLE == EEPROM_SDCARD
+/** Changed eeprom words are appended to eeprom.jnl until it reaches this size in bytes,
+then everything is compacted into eeprom.bin. 0 rewrites eeprom.bin on every sync. */
+#ifndef EEPROM_SD_JOURNAL_SIZE
+#define EEPROM_SD_JOURNAL_SIZE 0
+#endif
 extern millis_t eprSyncTime;
+#if EEPROM_SD_JOURNAL_SIZE
+extern uint8_t eprDirty[EEPROM_BYTES / 32]; // one bit per 4 byte word
+#endif
 #endif
 
 class HAL
@@ -468,6 +527,11 @@ class HAL
 #if EEPROM_AVAILABLE == EEPROM_SDCARD
     static void syncEEPROM(); // store to disk if changed
     static void importEEPROM();
+    static bool replayEEPROMJournal();
+#if EEPROM_SD_JOURNAL_SIZE
+    static bool writeEEPROMJournal();
+    static bool compactEEPROM();
+#endif
 #endif
 
     static inline void eprSetByte(unsigned int pos, uint8_t value)
@@ -597,6 +661,10 @@ class HAL
       i2cStop();          // signal end of transaction
       delayMilliseconds(EEPROM_PAGE_WRITE_TIME);   // wait for page write to complete
 #elif EEPROM_AVAILABLE == EEPROM_SDCARD
+#if EEPROM_SD_JOURNAL_SIZE
+      for(unsigned int w = pos >> 2; w <= (pos + size - 1) >> 2; w++)
+        eprDirty[w >> 3] |= 1 << (w & 7);
+#endif
       eprSyncTime = HAL::timeInMilliseconds() | 1UL; 
 #endif
     }
@@ -663,6 +731,10 @@ class HAL
     {
       return millis();
     }
+    static inline uint32_t timeInMicroseconds()
+    {
+      return micros();
+    }
     static inline char readFlashByte(PGM_P ptr)
     {
       return pgm_read_byte(ptr);
@@ -674,7 +746,9 @@ class HAL
 
     static inline void serialSetBaudrate(long baud)
     {
+#if !SERIAL_PDC
       Serial.setInterruptPriority(1);
+#endif
 #if defined(BLUETOOTH_SERIAL) && BLUETOOTH_SERIAL > 0
       BTAdapter.begin(baud);
 #else
@@ -713,6 +787,11 @@ class HAL
       RFSERIAL.flush();
 #endif
     }
+    // Bytes that can be written to the main port without waiting
+    static inline int serialOutputSpace()
+    {
+      return RFSERIAL.availableForWrite();
+    }
     static void setupTimer();
     static void showStartReason();
     static int getFreeRam();
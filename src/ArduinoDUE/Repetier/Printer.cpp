@@ -91,6 +91,9 @@ float Printer::autolevelTransformation[9]; ///< Transformation matrix
 uint32_t Printer::interval = 30000;           ///< Last step duration in ticks.
 uint32_t Printer::timer;              ///< used for acceleration/deceleration timing
 uint32_t Printer::stepNumber;         ///< Step number in current move.
+#if STEP_RAMP_TABLE
+ufast8_t Printer::rampIndex = 0;
+#endif
 #if USE_ADVANCE
 #if ENABLE_QUADRATIC_ADVANCE
 int32_t Printer::advanceExecuted;             ///< Executed advance steps
@@ -184,6 +187,20 @@ float Printer::maxRealSegmentLength = 0;
 #ifdef DEBUG_REAL_JERK
 float Printer::maxRealJerk = 0;
 #endif
+#ifdef DEBUG_STEPPER_TIMING
+uint32_t Printer::timingIsrTicks = 0;
+uint32_t Printer::timingIsrCalls = 0;
+uint32_t Printer::timingIsrSteps = 0;
+uint16_t Printer::timingIsrMaxTicks = 0;
+uint32_t Printer::timingPlannerMicros = 0;
+uint32_t Printer::timingPlannerLines = 0;
+uint32_t Printer::timingPlannerMaxMicros = 0;
+uint32_t Printer::timingReplannedLines = 0;
+uint16_t Printer::timingMaxReplanned = 0;
+uint16_t Printer::timingStarvations = 0;
+millis_t Printer::timingStarvedSince = 0;
+millis_t Printer::timingMaxStarvation = 0;
+#endif
 #if MULTI_XENDSTOP_HOMING
 fast8_t Printer::multiXHomeFlags;  // 1 = move X0, 2 = move X1
 #endif
@@ -386,6 +403,44 @@ void Printer::reportPrinterMode() {
         break;
     }
 }
+#ifdef DEBUG_STEPPER_TIMING
+void Printer::reportStepperTiming() {
+    InterruptProtectedBlock noInts;
+    uint32_t isrTicks = timingIsrTicks;
+    uint32_t isrCalls = timingIsrCalls;
+    uint32_t isrSteps = timingIsrSteps;
+    uint16_t isrMaxTicks = timingIsrMaxTicks;
+    noInts.unprotect();
+    Com::printF(PSTR("Stepper ISR calls:"), isrCalls);
+    Com::printF(PSTR(" steps:"), isrSteps);
+    Com::printFLN(PSTR(" max ticks:"), static_cast<int32_t>(isrMaxTicks));
+    if(isrSteps) {
+        Com::printF(PSTR("Ticks per step:"), static_cast<float>(isrTicks) / static_cast<float>(isrSteps), 1);
+        Com::printFLN(PSTR(" ticks per call:"), static_cast<float>(isrTicks) / static_cast<float>(isrCalls), 1);
+    }
+    Com::printF(PSTR("Planned lines:"), timingPlannerLines);
+    if(timingPlannerLines)
+        Com::printF(PSTR(" avg us:"), static_cast<float>(timingPlannerMicros) / static_cast<float>(timingPlannerLines), 1);
+    Com::printFLN(PSTR(" max us:"), timingPlannerMaxMicros);
+    if(timingPlannerLines)
+        Com::printF(PSTR("Replanned lines per line:"), static_cast<float>(timingReplannedLines) / static_cast<float>(timingPlannerLines), 2);
+    Com::printFLN(PSTR(" max:"), static_cast<int32_t>(timingMaxReplanned));
+    Com::printF(PSTR("Cache starvations:"), static_cast<int32_t>(timingStarvations));
+    Com::printFLN(PSTR(" max ms:"), static_cast<uint32_t>(timingMaxStarvation));
+}
+
+void Printer::resetStepperTiming() {
+    InterruptProtectedBlock noInts;
+    timingIsrTicks = timingIsrCalls = timingIsrSteps = 0;
+    timingIsrMaxTicks = 0;
+    timingPlannerMicros = timingPlannerLines = timingPlannerMaxMicros = 0;
+    timingReplannedLines = 0;
+    timingMaxReplanned = 0;
+    timingStarvations = 0;
+    timingStarvedSince = timingMaxStarvation = 0;
+}
+#endif
+
 void Printer::updateDerivedParameter() {
 #if NONLINEAR_SYSTEM
     travelMovesPerSecond = EEPROM::deltaSegmentsPerSecondMove();
@@ -1306,10 +1361,6 @@ void Printer::defaultLoopActions() {
 #if SDCARDDETECT > -1 && SDSUPPORT
     sd.automount();
 #endif
-#if defined(EEPROM_AVAILABLE) && EEPROM_AVAILABLE == EEPROM_SDCARD
-    HAL::syncEEPROM();
-#endif
-
     DEBUG_MEMORY;
 }
 
@@ -2221,7 +2272,7 @@ void Printer::showConfiguration() {
     Com::config(PSTR("ZProbe:"), FEATURE_Z_PROBE);
     Com::config(PSTR("Autolevel:"), FEATURE_AUTOLEVEL);
     Com::config(PSTR("EEPROM:"), EEPROM_MODE != 0);
-    Com::config(PSTR("PrintlineCache:"), PRINTLINE_CACHE_SIZE);
+    Com::config(PSTR("PrintlineCache:"), static_cast<int>(PRINTLINE_QUEUE_LENGTH));
     Com::config(PSTR("JerkXY:"), maxJerk);
     Com::config(PSTR("KeepAliveInterval:"), KEEP_ALIVE_INTERVAL);
 #if DRIVE_SYSTEM != DELTA
@@ -283,6 +283,9 @@ public:
     static uint32_t interval;    ///< Last step duration in ticks.
     static uint32_t timer;              ///< used for acceleration/deceleration timing
     static uint32_t stepNumber;         ///< Step number in current move.
+#if STEP_RAMP_TABLE
+    static ufast8_t rampIndex;          ///< Active speed band in ramp table of current move.
+#endif
     static float coordinateOffset[Z_AXIS_ARRAY];
     static int32_t currentPositionSteps[E_AXIS_ARRAY];     ///< Position in steps from origin.
     static float currentPosition[Z_AXIS_ARRAY]; ///< Position in global coordinates
@@ -401,6 +404,20 @@ public:
 #endif
 #ifdef DEBUG_REAL_JERK
     static float maxRealJerk;
+#endif
+#ifdef DEBUG_STEPPER_TIMING
+    static uint32_t timingIsrTicks;        ///< Sum of timer ticks spent in stepper interrupt
+    static uint32_t timingIsrCalls;        ///< Number of measured stepper interrupts
+    static uint32_t timingIsrSteps;        ///< Number of primary axis steps executed in these interrupts
+    static uint16_t timingIsrMaxTicks;     ///< Longest stepper interrupt in timer ticks
+    static uint32_t timingPlannerMicros;   ///< Sum of microseconds spent planning lines
+    static uint32_t timingPlannerLines;    ///< Number of planned lines
+    static uint32_t timingPlannerMaxMicros; ///< Longest time needed to plan a line
+    static uint32_t timingReplannedLines;  ///< Sum of lines with recomputed step parameters over all planned lines
+    static uint16_t timingMaxReplanned;    ///< Most lines recomputed for one new line
+    static uint16_t timingStarvations;     ///< Number of times the move cache ran empty while printing
+    static millis_t timingStarvedSince;    ///< Time the move cache ran empty, 0 if not empty
+    static millis_t timingMaxStarvation;   ///< Longest time in ms the move cache was empty while printing
 #endif
     // Print status related
     static int currentLayer;
@@ -1065,6 +1082,46 @@ public:
         WRITE(Z4_STEP_PIN, !START_STEP_WITH_HIGH);
 #endif
     }
+#ifdef DEBUG_STEPPER_TIMING
+    // Only called from within stepper interrupt
+    static INLINE void updateStepperTiming(uint16_t ticks) {
+        timingIsrTicks += ticks;
+        timingIsrCalls++;
+        if(ticks > timingIsrMaxTicks)
+            timingIsrMaxTicks = ticks;
+    }
+    static INLINE void updatePlannerTiming(uint32_t micros) {
+        timingPlannerMicros += micros;
+        timingPlannerLines++;
+        if(micros > timingPlannerMaxMicros)
+            timingPlannerMaxMicros = micros;
+    }
+    static INLINE void updateReplanTiming(uint16_t lines) {
+        timingReplannedLines += lines;
+        if(lines > timingMaxReplanned)
+            timingMaxReplanned = lines;
+    }
+    static void reportStepperTiming();
+    static void resetStepperTiming();
+#endif
+#if STEP_RAMP_TABLE
+    /** Sets interval and steps per timer call from a single step interval of a ramp table. */
+    static INLINE void setRampInterval(uint16_t stepInterval) {
+#if ALLOW_QUADSTEPPING
+        if(stepInterval < F_CPU / (STEP_DOUBLER_FREQUENCY * 2)) {
+            Printer::stepsPerTimerCall = 4;
+            Printer::interval = static_cast<uint32_t>(stepInterval) << 2;
+        } else
+#endif
+            if(stepInterval < F_CPU / STEP_DOUBLER_FREQUENCY) {
+                Printer::stepsPerTimerCall = 2;
+                Printer::interval = static_cast<uint32_t>(stepInterval) << 1;
+            } else {
+                Printer::stepsPerTimerCall = 1;
+                Printer::interval = stepInterval;
+            }
+    }
+#endif
     static INLINE speed_t updateStepsPerTimerCall(speed_t vbase) {
         if(vbase > STEP_DOUBLER_FREQUENCY) {
 #if ALLOW_QUADSTEPPING
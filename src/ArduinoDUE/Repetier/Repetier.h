@@ -72,6 +72,11 @@ usage or for searching for memory induced errors. Switch it off for production,
 //#define DEBUG_REAL_JERK
 // Debug reason for not mounting a sd card
 //#define DEBUG_SD_ERROR
+/** Collect timing statistics of stepper interrupt and path planner. M536 reports them, M536 S0 resets them.
+Use it to compare planner or stepper changes on a real printer. Costs some cycles in every stepper interrupt. */
+//#define DEBUG_STEPPER_TIMING
+/** Collect run time statistics of the scheduler tasks in the command loop. M537 reports them, M537 S0 resets them. */
+//#define DEBUG_SCHEDULER_TIMING
 // Uncomment the following line to enable debugging. You can better control debugging below the following line
 //#define DEBUG
 
@@ -284,6 +289,31 @@ inline void memcopy4(void *dest,void *source) {
 #ifndef JSON_OUTPUT
 #define JSON_OUTPUT 0
 #endif
+/** Keep the file info for JSON output in fileinfo.cac on the SD card, so selecting a file
+needs one cache read instead of scanning the file. Number of cached files, 0 disables it. */
+#ifndef SD_FILE_INFO_CACHE
+#define SD_FILE_INFO_CACHE 0
+#endif
+/** Slow tasks like display refresh are deferred up to this many milliseconds while the
+planner is running low on moves and commands are waiting. */
+#ifndef SCHEDULER_MAX_DEFER
+#define SCHEDULER_MAX_DEFER 400
+#endif
+/** Length of the repeating step pattern for mixing extruders. The stepper interrupt then
+takes the drive for each e step from the table instead of comparing the errors of all drives.
+Mixing ratios get a resolution of 1/MIXING_PATTERN_LENGTH. 0 uses the error comparison. */
+#ifndef MIXING_PATTERN_LENGTH
+#define MIXING_PATTERN_LENGTH 0
+#endif
+#if MIXING_PATTERN_LENGTH > 255
+#error MIXING_PATTERN_LENGTH must be 255 or less
+#endif
+/** Bytes for queued output. Com functions then store compact records and format them when
+the serial port has room, so a burst of output does not block the command loop. Info and
+echo lines are dropped if the queue is full, all other lines wait. 0 writes directly. */
+#ifndef COM_OUTPUT_QUEUE
+#define COM_OUTPUT_QUEUE 0
+#endif
 
 #if !defined(ZPROBE_MIN_TEMPERATURE) && defined(ZHOME_MIN_TEMPERATURE)
 #define ZPROBE_MIN_TEMPERATURE ZHOME_MIN_TEMPERATURE
@@ -321,7 +351,27 @@ inline void memcopy4(void *dest,void *source) {
 #endif
 #define MICROSTEP32 HIGH,HIGH
 
+/** Store buffered commands in a compact binary record containing only the parameters that are set.
+A typical move needs about 30 instead of 100 byte, so many more commands fit into the same ram.
+Only the command in execution gets expanded into a full GCode structure. New commands are only
+read while a worst case record still fits. */
+#ifndef GCODE_COMPACT_BUFFER
+#define GCODE_COMPACT_BUFFER 0
+#endif
+#ifndef GCODE_COMPACT_BUFFER_BYTES
+#define GCODE_COMPACT_BUFFER_BYTES 1024
+#endif
+/** Number of received commands buffered for execution. Each entry needs about 100 byte.
+A binary command frame can not contain more commands than there are free entries. */
+#ifndef GCODE_BUFFER_SIZE
+#if GCODE_COMPACT_BUFFER
+#define GCODE_BUFFER_SIZE 32
+#elif CPU_ARCH == ARCH_ARM
+#define GCODE_BUFFER_SIZE 8
+#else
 #define GCODE_BUFFER_SIZE 1
+#endif
+#endif
 
 #ifndef FEATURE_BABYSTEPPING
 #define FEATURE_BABYSTEPPING 0
@@ -594,6 +644,73 @@ inline void memcopy4(void *dest,void *source) {
 #define KEEP_ALIVE_INTERVAL 2000
 #endif
 
+/** Use precomputed step rate ramps instead of computing every interval in the stepper interrupt.
+The planner divides acceleration and deceleration into STEP_RAMP_TABLE_SIZE speed bands and stores
+the interval of each band in the line. This saves the multiplication and division in every accelerating
+or decelerating stepper interrupt, which limits the step rate on AVR boards. Each band costs
+8 byte per line in PRINTLINE_CACHE_SIZE, so keep the table small on AVR. */
+#ifndef STEP_RAMP_TABLE
+#define STEP_RAMP_TABLE 0
+#endif
+#ifndef STEP_RAMP_TABLE_SIZE
+#define STEP_RAMP_TABLE_SIZE 8
+#endif
+#if STEP_RAMP_TABLE && USE_ADVANCE
+#error STEP_RAMP_TABLE can not be combined with USE_ADVANCE, which needs the current speed in every step!
+#endif
+
+/** Cheaper planner math in PrintLine::calculateMove. The limiting axes for feedrate and acceleration
+are found by multiplications and only the limiting one is divided, constant divisions are folded.
+This replaces 9 of 14 soft float divisions per line for a typical XYE move on AVR at the cost of
+about 4 multiplications. Results differ from the default path only by float rounding, the interval
+by at most 1 tick. */
+#ifndef PLANNER_FAST_MATH
+#define PLANNER_FAST_MATH 0
+#endif
+
+/** Maximum deviation in micrometer between the linear tower moves of a delta segment and the
+real path. If set, delta moves get only as many segments as needed for this tolerance at
+their position, never more than DELTA_SEGMENTS_PER_SECOND_PRINT/MOVE allow. 0 uses the
+fixed segments per second. */
+#ifndef DELTA_SEGMENT_TOLERANCE
+#define DELTA_SEGMENT_TOLERANCE 0
+#endif
+
+/** Store distortion correction values as 16 bit steps instead of 32 bit. Halves ram and EEPROM
+usage, so permanent matrices up to 31x31 points fit. Values are limited to +-32767 steps.
+Measure again after changing this, stored matrices are not converted. */
+#ifndef DISTORTION_INT16
+#define DISTORTION_INT16 0
+#endif
+/** Keep a ram copy of the distortion matrix with DISTORTION_PERMANENT, so correction does
+not read the EEPROM. Only useful on AVR, where EEPROM is not cached in ram. Needs
+4 * DISTORTION_CORRECTION_POINTS^2 byte ram, 2 with DISTORTION_INT16. */
+#ifndef DISTORTION_RAM_CACHE
+#define DISTORTION_RAM_CACHE 0
+#endif
+/** Default heater feed forward for all extruders in PWM units per mm/s filament speed.
+The PID output gets this times the mean extrusion speed of the queued moves added, so the
+heater reacts before the temperature drops. M307 measures it, 0 disables it. */
+#ifndef EXTRUDER_FEED_FORWARD
+#define EXTRUDER_FEED_FORWARD 0
+#endif
+/** Number of 512 byte blocks in each of the two SD read ahead buffers, 0 disables read ahead.
+While one buffer gets parsed, the other one is filled between commands, so block reads do not
+stall parsing in the middle of a line. With 2 or more blocks the card reads them with one
+multi block command. Needs 1024 * SD_READ_AHEAD_BLOCKS byte ram. */
+#ifndef SD_READ_AHEAD_BLOCKS
+#define SD_READ_AHEAD_BLOCKS 0
+#endif
+/** Adds M35 to convert G-code files on SD card into binary files with a layer index,
+which print without text parsing and can be continued at a layer with M26 L<layer>. */
+#ifndef SD_BINARY_CONVERSION
+#define SD_BINARY_CONVERSION 0
+#endif
+#define SD_LAYER_INDEX_MAGIC 0x494C4252 // "RBLI" little endian
+#if DISTORTION_CORRECTION && DISTORTION_PERMANENT && 2048 + DISTORTION_CORRECTION_POINTS * DISTORTION_CORRECTION_POINTS * (DISTORTION_INT16 ? 2 : 4) > 4096
+#error Distortion matrix does not fit into EEPROM. Reduce DISTORTION_CORRECTION_POINTS or enable DISTORTION_INT16!
+#endif
+
 #include "HAL.h"
 #ifndef MAX_VFAT_ENTRIES
 #ifdef AVR_BOARD
@@ -967,7 +1084,6 @@ extern long baudrate;
 
 extern unsigned int counterPeriodical;
 extern volatile uint8_t executePeriodical;
-extern uint8_t counter500ms;
 extern void writeMonitor();
 #if FEATURE_FAN_CONTROL
 extern uint8_t fanKickstart;
@@ -1005,10 +1121,21 @@ public:
     //int16_t n;
     bool savetosd;
     SdBaseFile parentFound;
+    uint16_t bufferUnderruns; ///< Times the command buffer ran empty while printing
+    bool commandWasBuffered;
+#if SD_READ_AHEAD_BLOCKS
+    uint16_t readAheadStalls; ///< Times parsing had to wait for a block read
+    uint8_t readAheadBuffer[2][SD_READ_AHEAD_BLOCKS * 512];
+    uint16_t readAheadLength[2]; ///< Bytes in buffer, 0 = empty
+    uint16_t readAheadPos; ///< Next byte in current buffer
+    uint8_t readAheadCurrent; ///< Buffer being parsed
+    uint32_t readAheadFilePos; ///< File position of the next byte to fetch
+#endif
 
     SDCard();
     void initsd();
     void writeCommand(GCode *code);
+    uint8_t encodeCommand(GCode *code, uint8_t *buf);
     bool selectFile(const char *filename,bool silent=false);
     void mount();
     void unmount();
@@ -1021,7 +1148,24 @@ public:
         if(!sdactive) return;
         sdpos = newpos;
         file.seekSet(sdpos);
+#if SD_READ_AHEAD_BLOCKS
+        resetReadAhead();
+#endif
     }
+#if SD_READ_AHEAD_BLOCKS
+    void resetReadAhead();
+    bool fillReadAhead(uint8_t buffer);
+    void readAhead();
+    int readAheadByte();
+#endif
+    void countBufferUnderrun(bool commandBuffered);
+#if SD_BINARY_CONVERSION
+    uint32_t layerIndexStart; ///< File position of layer index in converted binary files
+    uint16_t layerCount; ///< Layers in index, 0 = no index
+    void readLayerIndex();
+    void setLayer(uint16_t layer);
+    void convertToBinary(char *filename);
+#endif
     void printStatus();
     void ls();
 #if JSON_OUTPUT
@@ -148,8 +148,17 @@ void SDCard::startPrint() {
     Printer::setMenuMode(MENU_MODE_SD_PRINTING, true);
     Printer::setMenuMode(MENU_MODE_PAUSED, false);
     Printer::setPrinting(true);
+#if SD_BINARY_CONVERSION
+    Printer::maxLayer = layerCount;
+#else
     Printer::maxLayer = 0;
+#endif
     Printer::currentLayer = 0;
+    bufferUnderruns = 0;
+    commandWasBuffered = false;
+#if SD_READ_AHEAD_BLOCKS
+    readAheadStalls = 0;
+#endif
     UI_STATUS_F(PSTR(""));
 #if NEW_COMMUNICATION
     GCodeSource::registerSource(&sdSource);
@@ -225,10 +234,28 @@ void SDCard::stopPrint() {
 }
 
 void SDCard::writeCommand(GCode *code) {
-    unsigned int sum1 = 0, sum2 = 0; // for fletcher-16 checksum
     uint8_t buf[100];
-    uint8_t p = 2;
     file.clearWriteError();
+    uint8_t p = encodeCommand(code, buf);
+    // Debug
+    /*Com::printF(PSTR("Buf: "));
+    for(int i=0;i<p;i++)
+    Com::printF(PSTR(" "),(int)buf[i]);
+    Com::println();*/
+    if(p == 0) {
+        Com::printErrorFLN(Com::tAPIDFinished);
+    } else
+        file.write(buf, p);
+    if (file.getWriteError()) {
+        Com::printFLN(Com::tErrorWritingToFile);
+    }
+}
+
+/** Encodes code as binary command with checksum into buf, which needs 100 byte.
+Returns the length or 0 if the command contains no data. */
+uint8_t SDCard::encodeCommand(GCode *code, uint8_t *buf) {
+    unsigned int sum1 = 0, sum2 = 0; // for fletcher-16 checksum
+    uint8_t p = 2;
     uint16_t params = 128 | (code->params & ~1);
     memcopy2(buf, &params);
     //*(int*)buf = params;
@@ -372,18 +399,7 @@ void SDCard::writeCommand(GCode *code) {
     }
     buf[p++] = sum1;
     buf[p++] = sum2;
-    // Debug
-    /*Com::printF(PSTR("Buf: "));
-    for(int i=0;i<p;i++)
-    Com::printF(PSTR(" "),(int)buf[i]);
-    Com::println();*/
-    if(params == 128) {
-        Com::printErrorFLN(Com::tAPIDFinished);
-    } else
-        file.write(buf, p);
-    if (file.getWriteError()) {
-        Com::printFLN(Com::tErrorWritingToFile);
-    }
+    return params == 128 ? 0 : p;
 }
 
 char *SDCard::createFilename(char *buffer, const dir_t &p) {
@@ -542,6 +558,13 @@ bool SDCard::selectFile(const char* filename, bool silent) {
 #endif
         sdpos = 0;
         filesize = file.fileSize();
+#if SD_BINARY_CONVERSION
+        readLayerIndex();
+#endif
+#if SD_READ_AHEAD_BLOCKS
+        file.seekSet(0);
+        resetReadAhead();
+#endif
         Com::printFLN(Com::tFileSelected);
         return true;
     } else {
@@ -555,11 +578,80 @@ void SDCard::printStatus() {
     if(sdactive) {
         Com::printF(Com::tSDPrintingByte, sdpos);
         Com::printFLN(Com::tSlash, filesize);
+        Com::printF(PSTR("SD buffer underruns:"), (int32_t)bufferUnderruns);
+#if SD_READ_AHEAD_BLOCKS
+        Com::printF(PSTR(" read stalls:"), (int32_t)readAheadStalls);
+#endif
+        Com::println();
     } else {
         Com::printFLN(Com::tNotSDPrinting);
     }
 }
 
+/** Counts how often the command buffer got empty while printing from SD card. Called
+from the command loop with the state of the buffer. */
+void SDCard::countBufferUnderrun(bool commandBuffered) {
+    if(sdmode != 1) return;
+    if(!commandBuffered && commandWasBuffered)
+        bufferUnderruns++;
+    commandWasBuffered = commandBuffered;
+}
+
+#if SD_READ_AHEAD_BLOCKS
+/** Drops the read ahead buffers, next bytes get fetched from the current file position sdpos. */
+void SDCard::resetReadAhead() {
+    readAheadLength[0] = readAheadLength[1] = 0;
+    readAheadPos = 0;
+    readAheadCurrent = 0;
+    readAheadFilePos = sdpos;
+}
+
+/** Reads the next part of the file into the read ahead buffer. Reads end at block
+boundaries, so following reads cover complete blocks, which the card transfers with one
+multi block read. Returns false on read errors. */
+bool SDCard::fillReadAhead(uint8_t buffer) {
+    uint16_t n = sizeof(readAheadBuffer[0]) - (readAheadFilePos & 511);
+    if(n > filesize - readAheadFilePos)
+        n = filesize - readAheadFilePos;
+    if(n == 0) return true;
+    if(file.read(readAheadBuffer[buffer], n) != n) {
+        Com::printFLN(Com::tSDReadError);
+        UI_ERROR("SD Read Error");
+        // Second try in case of recoverable errors
+        file.seekSet(readAheadFilePos);
+        if(file.read(readAheadBuffer[buffer], n) != n)
+            return false;
+        UI_ERROR("SD error fixed");
+    }
+    readAheadFilePos += n;
+    readAheadLength[buffer] = n;
+    return true;
+}
+
+/** Fills the free read ahead buffer while printing. Called between commands, so parsing
+finds the next block already in ram. */
+void SDCard::readAhead() {
+    uint8_t next = readAheadCurrent ^ 1;
+    if(sdmode != 1 || readAheadLength[next] != 0 || readAheadFilePos >= filesize) return;
+    fillReadAhead(next); // errors get reported when the buffer is needed
+}
+
+/** Returns next byte of the file or -1 on read errors. */
+int SDCard::readAheadByte() {
+    if(readAheadPos >= readAheadLength[readAheadCurrent]) {
+        readAheadLength[readAheadCurrent] = 0;
+        readAheadCurrent ^= 1;
+        readAheadPos = 0;
+        if(readAheadLength[readAheadCurrent] == 0) { // not read ahead in time
+            readAheadStalls++;
+            if(!fillReadAhead(readAheadCurrent) || readAheadLength[readAheadCurrent] == 0)
+                return -1;
+        }
+    }
+    return readAheadBuffer[readAheadCurrent][readAheadPos++];
+}
+#endif
+
 void SDCard::startWrite(char *filename) {
     if(!sdactive) return;
     file.close();
@@ -583,6 +675,156 @@ void SDCard::finishWrite() {
     UI_CLEAR_STATUS;
 }
 
+#if SD_BINARY_CONVERSION
+/** Work buffers of convertToBinary. It runs inside processMCode, so they are kept off the stack. */
+static struct {
+    uint8_t out[512]; // full blocks get written without cache
+    uint8_t command[100];
+    char line[MAX_CMD_SIZE];
+    GCode code;
+} binaryConversion;
+
+/** Checks if the selected file is a converted binary file with layer index. Then filesize
+gets reduced to the commands, so the index is not printed. */
+void SDCard::readLayerIndex() {
+    uint32_t footer[2];
+    layerCount = 0;
+    if(filesize >= sizeof(footer) && file.seekSet(filesize - sizeof(footer)) && file.read(footer, sizeof(footer)) == static_cast<int>(sizeof(footer))
+            && footer[1] == SD_LAYER_INDEX_MAGIC && footer[0] <= filesize - sizeof(footer) && ((filesize - sizeof(footer) - footer[0]) & 3) == 0) {
+        layerIndexStart = footer[0];
+        layerCount = (filesize - sizeof(footer) - footer[0]) >> 2;
+        filesize = layerIndexStart;
+        Printer::maxLayer = layerCount;
+        Com::printFLN(PSTR("Binary file layers:"), (int32_t)layerCount);
+    }
+    file.seekSet(0);
+}
+
+/** Continues printing at the start of layer (counted from 0) using the layer index. */
+void SDCard::setLayer(uint16_t layer) {
+    uint32_t pos;
+    if(!sdactive || layer >= layerCount) {
+        Com::printErrorFLN(PSTR("Layer not in index"));
+        return;
+    }
+    if(!file.seekSet(layerIndexStart + (static_cast<uint32_t>(layer) << 2)) || file.read(&pos, 4) != 4)
+        return;
+    setIndex(pos);
+    Printer::currentLayer = layer;
+}
+
+/** Converts an ascii G-code file into a binary file with same name and extension bgc.
+Commands are stored like M28 stores them in binary mode, so printing needs no text
+parsing. At the end follows the file offset of each layer, which starts with the last z
+change before the first extrusion above the previous layer, and a footer with index start
+and SD_LAYER_INDEX_MAGIC. Runs in the command loop, so start it while idle. */
+void SDCard::convertToBinary(char *filename) {
+    if(!sdactive || sdmode == 1 || savetosd) return;
+    char dest[LONG_FILENAME_LENGTH + 6];
+    strncpy(dest, filename, LONG_FILENAME_LENGTH);
+    dest[LONG_FILENAME_LENGTH] = 0;
+    char *ext = strrchr(dest, '.');
+    if(ext == NULL || strchr(ext, '/') != NULL) ext = dest + strlen(dest);
+    strcpy(ext, ".bgc");
+    sdmode = 0;
+    file.close();
+    fat.chdir();
+    SdFile src, dst, index;
+    if(!src.open(filename, O_READ)) {
+        Com::printFLN(Com::tOpenFailedFile, filename);
+        return;
+    }
+    if(!dst.open(dest, O_CREAT | O_WRITE | O_TRUNC) || !index.open("layers.tmp", O_CREAT | O_RDWR | O_TRUNC)) {
+        Com::printFLN(Com::tOpenFailedFile, dest);
+        src.close();
+        dst.close();
+        return;
+    }
+    uint8_t (&out)[512] = binaryConversion.out;
+    uint16_t outLen = 0;
+    uint32_t outPos = 0, commands = 0, zChangePos = 0;
+    uint16_t layers = 0;
+    float z = 0, layerZ = -1000;
+    bool relative = false, ok = true;
+    char *line = binaryConversion.line;
+    uint8_t len = 0;
+    bool comment = false;
+    int c;
+    GCode &code = binaryConversion.code;
+    do {
+        c = src.read();
+        if(c > 0 && c != '\n' && c != '\r') {
+            if(c == ';') comment = true;
+            if(!comment && len < MAX_CMD_SIZE - 1) line[len++] = c;
+            continue;
+        }
+        comment = false;
+        if(len == 0) continue;
+        line[len] = 0;
+        len = 0;
+        if(!code.parseAscii(line, false) || !(code.params & 518)) continue;
+        uint8_t *buf = binaryConversion.command;
+        uint8_t n = encodeCommand(&code, buf);
+        if(n == 0) continue;
+        if(code.hasG()) {
+            if(code.G == 90) relative = false;
+            else if(code.G == 91) relative = true;
+            else if(code.G <= 1) {
+                if(code.hasZ()) {
+                    z = relative ? z + code.Z : code.Z;
+                    zChangePos = outPos;
+                }
+                if(code.hasE() && (code.hasX() || code.hasY()) && z > layerZ + 0.001) { // first extrusion in new layer
+                    layerZ = z;
+                    layers++;
+                    index.write(&zChangePos, 4);
+                }
+            }
+        }
+        for(uint8_t i = 0; i < n; i++) {
+            out[outLen++] = buf[i];
+            if(outLen == sizeof(out)) {
+                ok &= dst.write(out, outLen) == outLen;
+                outLen = 0;
+            }
+        }
+        outPos += n;
+        if((++commands & 127) == 0) {
+            Commands::checkForPeriodicalActions(false);
+            GCode::keepAlive(Processing);
+        }
+    } while(c >= 0 && ok);
+    // append layer index and footer
+    uint32_t footer[2] = {outPos, SD_LAYER_INDEX_MAGIC};
+    index.seekSet(0);
+    while(ok && (c = index.read()) >= 0) {
+        out[outLen++] = c;
+        if(outLen == sizeof(out)) {
+            ok &= dst.write(out, outLen) == outLen;
+            outLen = 0;
+        }
+    }
+    if(outLen + sizeof(footer) > sizeof(out)) {
+        if(ok) ok = dst.write(out, outLen) == outLen;
+        outLen = 0;
+    }
+    memcpy(&out[outLen], footer, sizeof(footer));
+    outLen += sizeof(footer);
+    if(ok) ok = dst.write(out, outLen) == outLen;
+    ok &= dst.close();
+    src.close();
+    index.remove();
+    if(!ok) {
+        Com::printFLN(Com::tErrorWritingToFile);
+        fat.remove(dest);
+        return;
+    }
+    Com::printF(PSTR("Converted "), (int32_t)commands);
+    Com::printF(PSTR(" commands, layers:"), (int32_t)layers);
+    Com::printFLN(PSTR(" to "), dest);
+}
+#endif
+
 void SDCard::deleteFile(char *filename) {
     if(!sdactive) return;
     sdmode = 0;
@@ -634,12 +876,83 @@ void SDCard::writeToFile() {
 // Copy date: 15 Nov 2015                                          //
 // --------------------------------------------------------------- //
 
+#if SD_FILE_INFO_CACHE
+/** Record of the file info cache. Files are identified by first cluster, size and
+write time, so renamed or moved files keep their entry and changed files get a new one. */
+struct GCodeFileInfoRecord {
+    uint32_t firstCluster; // 0 = empty slot
+    uint32_t fileSize;
+    uint16_t date;
+    uint16_t time;
+    float objectHeight;
+    float layerHeight;
+    float filamentNeeded;
+    char generatedBy[GENBY_SIZE];
+};
+#define FILE_INFO_KEY_SIZE offsetof(GCodeFileInfoRecord, objectHeight)
+
+/** Sets the key of file and returns its home slot or -1 if file can not be cached. */
+static int16_t fileInfoCacheKey(SdFile &file, GCodeFileInfoRecord &key) {
+    dir_t d;
+    if(file.firstCluster() == 0 || !file.dirEntry(&d)) return -1;
+    key.firstCluster = file.firstCluster();
+    key.fileSize = file.fileSize();
+    key.date = d.lastWriteDate;
+    key.time = d.lastWriteTime;
+    return (key.firstCluster * 31 + key.fileSize * 17 + key.date * 7 + key.time) % SD_FILE_INFO_CACHE;
+}
+
+/** Opens the cache file, a new one gets all slots empty, so records can be written in place. */
+static bool fileInfoCacheOpen(SdFile &cache) {
+    if(cache.open("/fileinfo.cac", O_RDWR)) return true;
+    if(!cache.open("/fileinfo.cac", O_RDWR | O_CREAT)) return false;
+    GCodeFileInfoRecord empty;
+    memset(&empty, 0, sizeof(empty));
+    for(uint16_t i = 0; i < SD_FILE_INFO_CACHE; i++)
+        cache.write(&empty, sizeof(empty));
+    return cache.sync();
+}
+
+/** Searches the record of key in the slots following its home slot. Returns true if found.
+Otherwise slot is set to the first empty slot or stays at home slot to replace it. */
+static bool fileInfoCacheFind(SdFile &cache, GCodeFileInfoRecord &key, GCodeFileInfoRecord &rec, int16_t &slot) {
+    int16_t empty = -1;
+    for(uint8_t i = 0; i < 4; i++) {
+        int16_t s = (slot + i) % SD_FILE_INFO_CACHE;
+        if(!cache.seekSet(static_cast<uint32_t>(s) * sizeof(rec)) || cache.read(&rec, sizeof(rec)) != static_cast<int>(sizeof(rec)))
+            return false;
+        if(memcmp(&rec, &key, FILE_INFO_KEY_SIZE) == 0) {
+            slot = s;
+            return true;
+        }
+        if(rec.firstCluster == 0 && empty < 0) empty = s;
+    }
+    if(empty >= 0) slot = empty;
+    return false;
+}
+#endif
+
 void GCodeFileInfo::init(SdFile &file) {
     this->fileSize = file.fileSize();
     this->filamentNeeded = 0.0;
     this->objectHeight = 0.0;
     this->layerHeight = 0.0;
+    this->generatedBy[0] = 0;
     if (!file.isOpen()) return;
+#if SD_FILE_INFO_CACHE
+    SdFile cache;
+    GCodeFileInfoRecord key, rec;
+    int16_t slot = fileInfoCacheKey(file, key);
+    bool useCache = slot >= 0 && fileInfoCacheOpen(cache);
+    if(useCache && fileInfoCacheFind(cache, key, rec, slot)) {
+        objectHeight = rec.objectHeight;
+        layerHeight = rec.layerHeight;
+        filamentNeeded = rec.filamentNeeded;
+        memcpy(generatedBy, rec.generatedBy, GENBY_SIZE);
+        cache.close();
+        return;
+    }
+#endif
     bool genByFound = false, layerHeightFound = false, filamentNeedFound = false;
 #if CPU_ARCH==ARCH_AVR
 #define GCI_BUF_SIZE 120
@@ -675,6 +988,17 @@ get_objectHeight:
         if (findTotalHeight(buf, this->objectHeight)) break;
     }
     file.seekSet(0);
+#if SD_FILE_INFO_CACHE
+    if(useCache) {
+        key.objectHeight = objectHeight;
+        key.layerHeight = layerHeight;
+        key.filamentNeeded = filamentNeeded;
+        memcpy(key.generatedBy, generatedBy, GENBY_SIZE);
+        if(cache.seekSet(static_cast<uint32_t>(slot) * sizeof(key)))
+            cache.write(&key, sizeof(key));
+        cache.close();
+    }
+#endif
 }
 
 bool GCodeFileInfo::findGeneratedBy(char *buf, char *genBy) {
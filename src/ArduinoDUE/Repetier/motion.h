@@ -28,7 +28,7 @@
 #define FLAG_WARMUP 1
 #define FLAG_NOMINAL 2
 #define FLAG_DECELERATING 4
-#define FLAG_ACCELERATION_ENABLED 8 // unused
+#define FLAG_RAMP_TABLE 8 // Intervals are taken from precomputed ramp table
 #define FLAG_CHECK_ENDSTOPS 16
 #define FLAG_ALL_E_MOTORS 32 // For mixed extruder move all motors instead of selected motor
 #define FLAG_SKIP_DEACCELERATING 64 // unused
@@ -135,6 +135,13 @@ typedef struct {
 extern uint8_t lastMoveID;
 #endif
 class UIDisplay;
+/** Number of lines used in the move queue. On ARM boards the length is read from eeprom,
+PRINTLINE_CACHE_SIZE is the maximum. */
+#if CPU_ARCH == ARCH_ARM
+#define PRINTLINE_QUEUE_LENGTH PrintLine::linesMax
+#else
+#define PRINTLINE_QUEUE_LENGTH PRINTLINE_CACHE_SIZE
+#endif
 class PrintLine { // RAM usage: 24*4+15 = 113 Byte
     friend class UIDisplay;
 #if CPU_ARCH == ARCH_ARM
@@ -144,6 +151,9 @@ public:
     static ufast8_t linesPos; // Position for executing line movement
     static PrintLine lines[];
     static ufast8_t linesWritePos; // Position where we write the next cached line move
+#if CPU_ARCH == ARCH_ARM
+    static ufast8_t linesMax; // Used length of lines, set from eeprom up to PRINTLINE_CACHE_SIZE
+#endif
     ufast8_t joinFlags;
     volatile ufast8_t flags;
     secondspeed_t secondSpeed; // for laser intensity or fan control
@@ -179,6 +189,12 @@ private:
     speed_t vMax;              ///< Maximum reached speed in steps/s.
     speed_t vStart;            ///< Starting speed in steps/s.
     speed_t vEnd;              ///< End speed in steps/s
+#if STEP_RAMP_TABLE || defined(DOXYGEN)
+    uint16_t accelRampSteps[STEP_RAMP_TABLE_SIZE];    ///< Step number where acceleration band ends
+    uint16_t accelRampInterval[STEP_RAMP_TABLE_SIZE]; ///< Interval for one step in acceleration band
+    uint16_t decelRampSteps[STEP_RAMP_TABLE_SIZE];    ///< Remaining steps where deceleration band ends
+    uint16_t decelRampInterval[STEP_RAMP_TABLE_SIZE]; ///< Interval for one step in deceleration band
+#endif
 #if USE_ADVANCE
 #if ENABLE_QUADRATIC_ADVANCE
     int32_t advanceRate;               ///< Advance steps at full speed
@@ -526,6 +542,9 @@ public:
         if(stepsRemaining <= static_cast<int32_t>(decelSteps)) {
             if (!(flags & FLAG_DECELERATING)) {
                 Printer::timer = 0;
+#if STEP_RAMP_TABLE
+                Printer::rampIndex = 0;
+#endif
                 flags |= FLAG_DECELERATING;
             }
             return true;
@@ -534,6 +553,24 @@ public:
     INLINE bool moveAccelerating() {
         return Printer::stepNumber <= accelSteps;
     }
+#if STEP_RAMP_TABLE
+    INLINE bool isRampTable() {
+        return flags & FLAG_RAMP_TABLE;
+    }
+    // Only called from bresenham -> inside interrupt handle
+    INLINE void updateAccelerationFromRamp() {
+        while(Printer::stepNumber >= accelRampSteps[Printer::rampIndex])
+            Printer::rampIndex++;
+        Printer::setRampInterval(accelRampInterval[Printer::rampIndex]);
+    }
+    // Only called from bresenham -> inside interrupt handle
+    INLINE void updateDecelerationFromRamp() {
+        while(stepsRemaining < static_cast<int32_t>(decelRampSteps[Printer::rampIndex]))
+            Printer::rampIndex++;
+        Printer::setRampInterval(decelRampInterval[Printer::rampIndex]);
+    }
+    void computeRampTables();
+#endif
     INLINE void startXStep() {
 #if !(GANTRY) || defined(FAST_COREXYZ)
         Printer::startXStep();
@@ -645,19 +682,35 @@ public:
 #endif
         HAL::forbidInterrupts();
         --linesCount;
-        if(!linesCount)
+        if(!linesCount) {
             Printer::setMenuMode(MENU_MODE_PRINTING, Printer::isPrinting());
+#ifdef DEBUG_STEPPER_TIMING
+            if(Printer::isPrinting()) {
+                Printer::timingStarvations++;
+                Printer::timingStarvedSince = HAL::timeInMilliseconds() | 1; // 0 means not starved
+            }
+#endif
+        }
     }
     static INLINE void pushLine() {
         nextPlannerIndex(linesWritePos);
         Printer::setMenuMode(MENU_MODE_PRINTING, true);
         InterruptProtectedBlock noInts;
+#ifdef DEBUG_STEPPER_TIMING
+        if(Printer::timingStarvedSince) {
+            millis_t starved = HAL::timeInMilliseconds() - Printer::timingStarvedSince;
+            if(starved > Printer::timingMaxStarvation)
+                Printer::timingMaxStarvation = starved;
+            Printer::timingStarvedSince = 0;
+        }
+#endif
         linesCount++;
     }
-    static uint8_t getLinesCount() {
+    static ufast8_t getLinesCount() {
         InterruptProtectedBlock noInts;
         return linesCount;
     }
+    static float queuedExtrusionSpeed();
     static PrintLine *getNextWriteLine() {
         return &lines[linesWritePos];
     }
@@ -665,7 +718,7 @@ public:
     static int32_t bresenhamStep();
     static void waitForXFreeLines(uint8_t b = 1, bool allowMoves = false);
     static inline void forwardPlanner(ufast8_t p);
-    static inline void backwardPlanner(ufast8_t p, ufast8_t last);
+    static inline ufast8_t backwardPlanner(ufast8_t p, ufast8_t last);
     static void updateTrapezoids();
     static uint8_t insertWaitMovesIfNeeded(uint8_t pathOptimize, uint8_t waitExtraLines);
     static void LaserWarmUp(uint32_t wait);
@@ -681,11 +734,14 @@ public:
     static void arc(float *position, float *target, float *offset, float radius, uint8_t isclockwise);
 #endif
     static INLINE void previousPlannerIndex(ufast8_t &p) {
-        p = (p ? p - 1 : PRINTLINE_CACHE_SIZE - 1);
+        p = (p ? p - 1 : PRINTLINE_QUEUE_LENGTH - 1);
     }
     static INLINE void nextPlannerIndex(ufast8_t& p) {
-        p = (p >= PRINTLINE_CACHE_SIZE - 1 ? 0 : p + 1);
+        p = (p >= PRINTLINE_QUEUE_LENGTH - 1 ? 0 : p + 1);
     }
+#if CPU_ARCH == ARCH_ARM
+    static void setQueueLength(int16_t length);
+#endif
 #if NONLINEAR_SYSTEM || defined(DOXYGEN)
     static uint8_t queueNonlinearMove(uint8_t check_endstops, uint8_t pathOptimize, uint8_t softEndstop);
     static inline void queueEMove(int32_t e_diff, uint8_t check_endstops, uint8_t pathOptimize);